@@ -0,0 +1,585 @@
+// 不依赖OpenGL的性能与精度测试
+//   solar_bench gravity [N] [theta...]   Barnes-Hut与直接求和的速度和加速度误差对比
+//   solar_bench wh [years] [stepDays]    Wisdom-Holman积分八大行星的吞吐量和能量误差
+//   solar_bench determinism [N] [steps]  1、8、64个线程下N体状态的校验和是否逐位一致
+//   solar_bench snapshot [N]             N体快照的保存（后台写出）与内存映射恢复耗时
+//   solar_bench belt [N...]              小天体带每帧求解位置的耗时（单线程与线程池）
+//   solar_bench ephemeris <file>         切比雪夫星历的逐帧查询、跨世纪跳转和完全随机查询的耗时与缓存命中率
+//   solar_bench sgp4 [N | file]          SGP4与参考结果的偏差，以及N颗卫星（默认30000）或TLE文件中的卫星每帧传播的耗时
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "../include/asteroid_belt.h"
+#include "../include/barnes_hut.h"
+#include "../include/checksum.h"
+#include "../include/ephemeris.h"
+#include "../include/nbody.h"
+#include "../include/parallel_for.h"
+#include "../include/sgp4.h"
+#include "../include/snapshot.h"
+#include "../include/wisdom_holman.h"
+
+namespace {
+
+double secondsSince(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// 中心天体加一个厚盘的测试粒子，质量相近，分布与小行星带类似
+struct Cloud {
+    std::vector<double> x, y, z, mass;
+};
+
+Cloud makeCloud(size_t count)
+{
+    Cloud cloud;
+    std::mt19937 random(12345);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    for (size_t i = 0; i < count; ++i) {
+        double r = 16.5 + 4.0 * unit(random);
+        double angle = 6.283185307179586 * unit(random);
+        cloud.x.push_back(r * std::cos(angle));
+        cloud.y.push_back(0.5 * (unit(random) - 0.5));
+        cloud.z.push_back(-r * std::sin(angle));
+        cloud.mass.push_back(1.0 / count);
+    }
+    return cloud;
+}
+
+// 直接求和，只计算sample中的天体
+void directAccelerations(const Cloud& cloud, const std::vector<size_t>& sample, double softening2,
+                         std::vector<double>& ax, std::vector<double>& ay, std::vector<double>& az, ThreadPool& pool)
+{
+    const size_t n = cloud.x.size();
+    pool.ParallelFor(0, sample.size(), 16, [&](size_t begin, size_t end) {
+        for (size_t s = begin; s < end; ++s) {
+            size_t i = sample[s];
+            double accX = 0.0, accY = 0.0, accZ = 0.0;
+            for (size_t j = 0; j < n; ++j) {
+                double dx = cloud.x[j] - cloud.x[i], dy = cloud.y[j] - cloud.y[i], dz = cloud.z[j] - cloud.z[i];
+                double r2 = dx * dx + dy * dy + dz * dz;
+                double inv = r2 > 0.0 ? 1.0 / std::sqrt(r2 + softening2) : 0.0;
+                double m = cloud.mass[j] * inv * inv * inv;
+                accX += dx * m;
+                accY += dy * m;
+                accZ += dz * m;
+            }
+            ax[s] = accX;
+            ay[s] = accY;
+            az[s] = accZ;
+        }
+    });
+}
+
+int benchGravity(int argc, char** argv)
+{
+    const size_t count = argc > 0 ? std::strtoull(argv[0], nullptr, 10) : 100000;
+    std::vector<double> thetas;
+    for (int i = 1; i < argc; ++i) {
+        thetas.push_back(std::atof(argv[i]));
+    }
+    if (thetas.empty()) {
+        thetas = { 0.3, 0.5, 0.7, 1.0 };
+    }
+    const double softening2 = 1e-4;
+
+    ThreadPool pool;
+    Cloud cloud = makeCloud(count);
+    std::printf("gravity: %zu bodies, %u threads\n", count, pool.Size());
+
+    // 直接求和只算一部分天体作为参考，整体耗时按比例推算
+    const size_t sampleCount = count < 2000 ? count : 2000;
+    std::vector<size_t> sample(sampleCount);
+    for (size_t s = 0; s < sampleCount; ++s) {
+        sample[s] = s * count / sampleCount;
+    }
+    std::vector<double> refX(sampleCount), refY(sampleCount), refZ(sampleCount);
+    auto start = std::chrono::steady_clock::now();
+    directAccelerations(cloud, sample, softening2, refX, refY, refZ, pool);
+    const double directSeconds = secondsSince(start) * count / sampleCount;
+    std::printf("  direct      : %10.2f ms/step (extrapolated), %8.1f M interactions/s\n",
+                directSeconds * 1000.0, double(count) * count / directSeconds / 1e6);
+
+    BarnesHutTree tree;
+    std::vector<double> ax(count), ay(count), az(count);
+    for (double theta : thetas) {
+        start = std::chrono::steady_clock::now();
+        tree.Build(cloud.x.data(), cloud.y.data(), cloud.z.data(), cloud.mass.data(), count, &pool);
+        const double buildSeconds = secondsSince(start);
+        start = std::chrono::steady_clock::now();
+        unsigned long long interactions = tree.Accelerations(theta, 1.0, softening2, ax.data(), ay.data(), az.data(), &pool);
+        const double walkSeconds = secondsSince(start);
+
+        // 相对误差 |a_bh - a_direct| / |a_direct|
+        double sumError2 = 0.0, maxError = 0.0;
+        for (size_t s = 0; s < sampleCount; ++s) {
+            size_t i = sample[s];
+            double ex = ax[i] - refX[s], ey = ay[i] - refY[s], ez = az[i] - refZ[s];
+            double ref = std::sqrt(refX[s] * refX[s] + refY[s] * refY[s] + refZ[s] * refZ[s]);
+            double error = std::sqrt(ex * ex + ey * ey + ez * ez) / ref;
+            sumError2 += error * error;
+            maxError = std::max(maxError, error);
+        }
+
+        std::printf("  theta = %.2f: %10.2f ms/step (build %.2f ms, %zu nodes), %6.1fx faster, "
+                    "%.1f interactions/body, rms error %.2e, max error %.2e\n",
+                    theta, (buildSeconds + walkSeconds) * 1000.0, buildSeconds * 1000.0, tree.NodeCount(),
+                    directSeconds / (buildSeconds + walkSeconds), double(interactions) / count,
+                    std::sqrt(sumError2 / sampleCount), maxError);
+    }
+    return 0;
+}
+
+// J2000历元的行星轨道根数，单位AU、度；质量以太阳质量为单位
+struct PlanetElements {
+    const char* name;
+    double mass;
+    double a, e, i, node, peri, meanAnomaly;
+};
+
+const PlanetElements PLANETS[] = {
+    { "Mercury", 1.66e-7,   0.387,  0.2056, 7.005, 48.331,  29.124,  174.796 },
+    { "Venus",   2.448e-6,  0.723,  0.0068, 3.395, 76.68,   54.884,  50.115 },
+    { "Earth",   3.003e-6,  1.0,    0.0167, 0.0,   -11.261, 114.208, -1.383 },
+    { "Mars",    3.227e-7,  1.524,  0.0934, 1.85,  49.558,  286.502, 19.373 },
+    { "Jupiter", 9.548e-4,  5.203,  0.0484, 1.303, 100.464, 273.867, 20.02 },
+    { "Saturn",  2.859e-4,  9.537,  0.0539, 2.485, 113.665, 339.392, -42.98 },
+    { "Uranus",  4.366e-5,  19.19,  0.0473, 0.773, 74.006,  96.999,  142.238 },
+    { "Neptune", 5.151e-5,  30.07,  0.0086, 1.77,  131.784, 273.187, -103.772 },
+};
+
+// 高斯引力常数的平方，单位AU^3 / (太阳质量 * 日^2)
+const double GAUSS_GRAVITY = 0.01720209895 * 0.01720209895;
+
+// 轨道根数转为日心位置和速度
+void elementsToState(const PlanetElements& p, double mu, double* position, double* velocity)
+{
+    const double degree = 3.141592653589793 / 180.0;
+    double M = p.meanAnomaly * degree;
+    double E = M;
+    for (int k = 0; k < 20; ++k) {
+        E -= (E - p.e * std::sin(E) - M) / (1.0 - p.e * std::cos(E));
+    }
+
+    // 轨道平面内的位置和速度
+    const double b = p.a * std::sqrt(1.0 - p.e * p.e);
+    const double r = p.a * (1.0 - p.e * std::cos(E));
+    const double n = std::sqrt(mu / (p.a * p.a * p.a));
+    const double px = p.a * (std::cos(E) - p.e), py = b * std::sin(E);
+    const double vx = -p.a * n * std::sin(E) * p.a / r, vy = b * n * std::cos(E) * p.a / r;
+
+    // 依次绕z轴转近心点幅角、绕x轴转倾角、绕z轴转升交点经度
+    const double cw = std::cos(p.peri * degree), sw = std::sin(p.peri * degree);
+    const double ci = std::cos(p.i * degree), si = std::sin(p.i * degree);
+    const double cn = std::cos(p.node * degree), sn = std::sin(p.node * degree);
+    const double P[3] = { cn * cw - sn * sw * ci, sn * cw + cn * sw * ci, sw * si };
+    const double Q[3] = { -cn * sw - sn * cw * ci, -sn * sw + cn * cw * ci, cw * si };
+    for (int k = 0; k < 3; ++k) {
+        position[k] = P[k] * px + Q[k] * py;
+        velocity[k] = P[k] * vx + Q[k] * vy;
+    }
+}
+
+int benchWisdomHolman(int argc, char** argv)
+{
+    const double years = argc > 0 ? std::atof(argv[0]) : 10000.0;
+    const double stepDays = argc > 1 ? std::atof(argv[1]) : 5.0;
+    const double daysPerYear = 365.25;
+    const long long steps = static_cast<long long>(years * daysPerYear / stepDays);
+
+    WisdomHolman system(GAUSS_GRAVITY, 1.0);
+    for (const PlanetElements& planet : PLANETS) {
+        double position[3], velocity[3];
+        elementsToState(planet, GAUSS_GRAVITY * (1.0 + planet.mass), position, velocity);
+        system.Add(planet.mass, position[0], position[1], position[2], velocity[0], velocity[1], velocity[2]);
+    }
+    std::printf("wh: %zu planets, %.0f years, step %.2f days (%lld steps)\n", system.Size(), years, stepDays, steps);
+
+    const double initialEnergy = system.Energy();
+    double maxError = 0.0;
+    const long long sampleInterval = steps / 1000 > 0 ? steps / 1000 : 1;
+    double integrateSeconds = 0.0;
+    for (long long done = 0; done < steps;) {
+        const long long batch = std::min(sampleInterval, steps - done);
+        auto start = std::chrono::steady_clock::now();
+        for (long long k = 0; k < batch; ++k) {
+            system.Step(stepDays);
+        }
+        integrateSeconds += secondsSince(start);
+        done += batch;
+
+        // 能量只在采样点计算，不计入积分耗时
+        maxError = std::max(maxError, std::fabs((system.Energy() - initialEnergy) / initialEnergy));
+    }
+    const double finalError = std::fabs((system.Energy() - initialEnergy) / initialEnergy);
+
+    std::printf("  %.3f s, %.0f sim-years per wall-second, %.2f us/step\n",
+                integrateSeconds, years / integrateSeconds, integrateSeconds / steps * 1e6);
+    std::printf("  relative energy error: max %.2e, final %.2e\n", maxError, finalError);
+    return 0;
+}
+
+// 用给定线程数积分一个旋转的粒子盘，返回每checkInterval步的状态校验和
+std::vector<uint64_t> runDeterminism(const Cloud& cloud, GravitySolver solver, unsigned int threads,
+                                     int steps, int checkInterval)
+{
+    NBodySystem system(1.0, 0.01);
+    for (size_t i = 0; i < cloud.x.size(); ++i) {
+        double r = std::sqrt(cloud.x[i] * cloud.x[i] + cloud.z[i] * cloud.z[i]);
+        double speed = std::sqrt(1.0 / r);
+        system.Add(cloud.mass[i], cloud.x[i], cloud.y[i], cloud.z[i], -speed * cloud.z[i] / r, 0.0, speed * cloud.x[i] / r);
+    }
+    system.SetSolver(solver, 0.5);
+
+    ThreadPool pool(threads);
+    std::vector<uint64_t> checksums;
+    for (int step = 1; step <= steps; ++step) {
+        system.Step(0.01, &pool);
+        if (step % checkInterval == 0) {
+            checksums.push_back(system.Checksum());
+        }
+    }
+    return checksums;
+}
+
+int benchDeterminism(int argc, char** argv)
+{
+    const size_t count = argc > 0 ? std::strtoull(argv[0], nullptr, 10) : 20000;
+    const int steps = argc > 1 ? std::atoi(argv[1]) : 20;
+    const int checkInterval = steps >= 5 ? steps / 5 : 1;
+    const unsigned int threadCounts[] = { 1, 8, 64 };
+
+    Cloud cloud = makeCloud(count);
+    std::printf("determinism: %zu bodies, %d steps, checksum every %d steps\n", count, steps, checkInterval);
+
+    bool identical = true;
+    for (GravitySolver solver : { GravitySolver::Direct, GravitySolver::BarnesHut }) {
+        std::vector<uint64_t> reference;
+        for (unsigned int threads : threadCounts) {
+            auto start = std::chrono::steady_clock::now();
+            std::vector<uint64_t> checksums = runDeterminism(cloud, solver, threads, steps, checkInterval);
+            const double seconds = secondsSince(start);
+            if (reference.empty()) {
+                reference = checksums;
+            }
+            const bool match = checksums == reference;
+            identical = identical && match;
+            std::printf("  %-10s %2u threads: %8.2f ms/step, final checksum %016llx %s\n",
+                        solver == GravitySolver::Direct ? "direct" : "barnes-hut", threads,
+                        seconds / steps * 1000.0, static_cast<unsigned long long>(checksums.back()),
+                        match ? "(identical)" : "(MISMATCH)");
+        }
+    }
+    std::printf("  %s\n", identical ? "all runs bit-identical" : "runs differ");
+    return identical ? 0 : 1;
+}
+
+int benchSnapshot(int argc, char** argv)
+{
+    const size_t count = argc > 0 ? std::strtoull(argv[0], nullptr, 10) : 1000000;
+    const char* path = "solar_bench.snapshot";
+
+    Cloud cloud = makeCloud(count);
+    NBodySystem system(1.0, 0.01);
+    for (size_t i = 0; i < count; ++i) {
+        system.Add(cloud.mass[i], cloud.x[i], cloud.y[i], cloud.z[i], 0.1 * cloud.z[i], 0.0, -0.1 * cloud.x[i]);
+    }
+    std::printf("snapshot: %zu bodies\n", count);
+
+    // 保存：帧循环中只有拷贝状态这一步，写文件在后台。
+    // 第一次保存需要分配缓冲区，之后重复使用回收的缓冲区
+    SnapshotWriter writer;
+    double captureSeconds[2] = {}, writeSeconds = 0.0;
+    for (int round = 0; round < 2; ++round) {
+        auto start = std::chrono::steady_clock::now();
+        SnapshotData data = writer.Recycle();
+        data.flags = SNAPSHOT_NBODY;
+        data.gravity = system.Gravity();
+        data.softening = system.Softening();
+        data.nbodyCount = count;
+        const double* components[] = { system.X(), system.Y(), system.Z(), system.VX(), system.VY(), system.VZ(), system.Mass() };
+        for (size_t k = 0; k < 7; ++k) {
+            data.nbodyState.insert(data.nbodyState.end(), components[k], components[k] + count);
+        }
+        writer.Save(path, std::move(data));
+        captureSeconds[round] = secondsSince(start);
+        while (writer.Busy()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        writeSeconds = secondsSince(start);
+    }
+
+    // 恢复：映射文件并整段拷贝到新的系统
+    auto start = std::chrono::steady_clock::now();
+    SnapshotReader reader;
+    if (!reader.Open(path)) {
+        std::printf("  failed to open %s\n", path);
+        return 1;
+    }
+    NBodySystem restored(reader.Header().gravity, reader.Header().softening);
+    restored.Assign(reader.Header().nbodyCount, reader.NBody(0), reader.NBody(1), reader.NBody(2),
+                    reader.NBody(3), reader.NBody(4), reader.NBody(5), reader.NBody(6));
+    const double restoreSeconds = secondsSince(start);
+
+    const bool identical = restored.Checksum() == system.Checksum();
+    std::printf("  save: %.2f ms in the frame loop (first save %.2f ms), %.2f ms until written (%.1f MB)\n",
+                captureSeconds[1] * 1000.0, captureSeconds[0] * 1000.0, writeSeconds * 1000.0, reader.Header().fileSize / 1e6);
+    std::printf("  restore: %.2f ms, state %s\n", restoreSeconds * 1000.0, identical ? "identical" : "DIFFERS");
+    std::remove(path);
+    return identical ? 0 : 1;
+}
+
+int benchBelt(int argc, char** argv)
+{
+    std::vector<size_t> counts;
+    for (int i = 0; i < argc; ++i) {
+        counts.push_back(std::strtoull(argv[i], nullptr, 10));
+    }
+    if (counts.empty()) {
+        counts = { 10000, 100000, 300000, 1000000 };
+    }
+
+    ThreadPool pool;
+    std::printf("belt: %u threads\n", pool.Size());
+    for (size_t count : counts) {
+        // 与程序中相同的分布：三分之二在主带，其余在柯伊伯带
+        AsteroidBelt belt(1.0);
+        belt.AddRing(count - count / 3, 16.0f, 18.0f, 0.15f, 0.26f, 1);
+        belt.AddRing(count / 3, 48.0f, 60.0f, 0.2f, 0.35f, 2);
+        std::vector<float> points(3 * count);
+
+        // 每帧求解一次，时间每帧前进一点
+        const int frames = 50;
+        double seconds[2] = {};
+        for (int mode = 0; mode < 2; ++mode) {
+            auto start = std::chrono::steady_clock::now();
+            for (int frame = 0; frame < frames; ++frame) {
+                belt.Evaluate(frame * 0.01, 0.0f, 0.0f, 0.0f, points.data(), mode == 0 ? nullptr : &pool);
+            }
+            seconds[mode] = secondsSince(start) / frames;
+        }
+        std::printf("  %8zu bodies: %7.2f ms/frame single-threaded, %6.2f ms/frame on the pool (%.0f M bodies/s)\n",
+                    count, seconds[0] * 1000.0, seconds[1] * 1000.0, count / seconds[1] / 1e6);
+    }
+    return 0;
+}
+
+int benchEphemeris(int argc, char** argv)
+{
+    if (argc < 1) {
+        std::printf("ephemeris: missing file (create one with make_ephemeris)\n");
+        return 1;
+    }
+    Ephemeris ephemeris;
+    auto start = std::chrono::steady_clock::now();
+    if (!ephemeris.Open(argv[0])) {
+        std::printf("ephemeris: failed to open %s\n", argv[0]);
+        return 1;
+    }
+    std::printf("ephemeris: %s, %zu bodies, JD %.1f - %.1f, opened in %.3f ms\n", argv[0], ephemeris.BodyCount(),
+                ephemeris.StartDay(), ephemeris.EndDay(), secondsSince(start) * 1000.0);
+
+    const double span = ephemeris.EndDay() - ephemeris.StartDay();
+    const size_t lookups = 1000000;
+    std::mt19937 random(7);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+
+    // 三种访问方式：每帧前进约一天；在8个相隔几个世纪的时刻之间来回跳转（每次附近略有变化）；整个范围内完全随机
+    std::vector<double> epochs;
+    for (int i = 0; i < 8; ++i) {
+        epochs.push_back(ephemeris.StartDay() + span * (i + 0.5) / 8.0);
+    }
+    const char* names[] = { "sequential", "jumping", "random" };
+    double sum = 0.0;
+    for (int mode = 0; mode < 3; ++mode) {
+        std::vector<double> days(lookups);
+        for (size_t i = 0; i < lookups; ++i) {
+            if (mode == 0) {
+                days[i] = ephemeris.StartDay() + std::fmod(i * 1.01, span);
+            } else if (mode == 1) {
+                days[i] = epochs[random() % epochs.size()] + 10.0 * unit(random);
+            } else {
+                days[i] = ephemeris.StartDay() + span * unit(random);
+            }
+        }
+        const uint64_t hits = ephemeris.CacheHits(), misses = ephemeris.CacheMisses();
+        start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < lookups; ++i) {
+            double position[3];
+            ephemeris.Position(i % ephemeris.BodyCount(), days[i], position);
+            sum += position[0];
+        }
+        const double seconds = secondsSince(start);
+        const uint64_t h = ephemeris.CacheHits() - hits, m = ephemeris.CacheMisses() - misses;
+        std::printf("  %-10s %6.1f ns/lookup, cache hit rate %6.2f%% (%llu misses)\n", names[mode],
+                    seconds / lookups * 1e9, 100.0 * h / (h + m), static_cast<unsigned long long>(m));
+    }
+
+    // J2000时地球（地月质心）的位置，用于和公布的星历比对
+    int earth = ephemeris.FindBody("Earth");
+    double position[3];
+    if (earth >= 0 && ephemeris.Position(earth, 2451545.0, position)) {
+        std::printf("  Earth at J2000: (%.6f, %.6f, %.6f) AU\n", position[0], position[1], position[2]);
+    }
+    return sum == 12345.0 ? 1 : 0;
+}
+
+// 合成的卫星根数，近似实际编目的构成：大部分在低轨的几个星座壳层，其余为中轨、地球同步和大椭圆轨道
+std::vector<TwoLineElements> makeSatellites(size_t count)
+{
+    const double DEG = 3.14159265358979323846 / 180.0;
+    std::mt19937 random(2024);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    std::vector<TwoLineElements> satellites;
+    for (size_t i = 0; i < count; ++i) {
+        TwoLineElements tle = {};
+        tle.catalogNumber = static_cast<int>(i);
+        tle.epoch = 2460000.5 + unit(random);
+        double revolutionsPerDay, eccentricity, inclination;
+        double kind = unit(random);
+        if (kind < 0.85) {
+            revolutionsPerDay = 14.0 + 1.8 * unit(random);
+            eccentricity = 0.02 * unit(random) * unit(random);
+            inclination = (unit(random) < 0.5 ? 53.0 : 97.5) + 2.0 * unit(random);
+        } else if (kind < 0.92) {
+            revolutionsPerDay = 2.0 + 0.2 * unit(random);
+            eccentricity = 0.01 * unit(random);
+            inclination = 55.0 + 10.0 * unit(random);
+        } else if (kind < 0.97) {
+            revolutionsPerDay = 1.0027 + 0.01 * (unit(random) - 0.5);
+            eccentricity = 0.001 * unit(random);
+            inclination = 5.0 * unit(random);
+        } else {
+            revolutionsPerDay = 2.0 + 0.05 * unit(random);
+            eccentricity = 0.7 + 0.05 * unit(random);
+            inclination = 63.4;
+        }
+        tle.bstar = 1e-4 * unit(random);
+        tle.inclination = inclination * DEG;
+        tle.ascendingNode = 360.0 * unit(random) * DEG;
+        tle.eccentricity = eccentricity;
+        tle.argumentOfPerigee = 360.0 * unit(random) * DEG;
+        tle.meanAnomaly = 360.0 * unit(random) * DEG;
+        tle.meanMotion = revolutionsPerDay * 2.0 * 3.14159265358979323846 / 1440.0;
+        satellites.push_back(tle);
+    }
+    return satellites;
+}
+
+int benchSgp4(int argc, char** argv)
+{
+    // Vallado等人"Revisiting Spacetrack Report #3"验证集中的00005号卫星，及其发布的TEME位置（km）
+    const char* line1 = "1 00005U 58002B   00179.78495062  .00000023  00000-0  28098-4 0  4753";
+    const char* line2 = "2 00005  34.2682 348.7242 1859667 331.7664  19.3264 10.82419157413667";
+    const double minutes[] = { 0.0, 360.0, 720.0, 1080.0 };
+    const double expected[][3] = {
+        { 7022.46529266, -1400.08296755, 0.03995155 },
+        { -7154.03120202, -3783.17682504, -3536.19412294 },
+        { -7134.59340119, 6531.68641334, 3260.27186483 },
+        { 5568.53901181, 4492.06992591, 3863.87641983 },
+    };
+    TwoLineElements reference;
+    Sgp4Batch check;
+    if (!ParseTwoLineElements(line1, line2, reference) || !check.Add(reference)) {
+        std::printf("sgp4: failed to parse the reference elements\n");
+        return 1;
+    }
+    double worst = 0.0;
+    for (int i = 0; i < 4; ++i) {
+        check.Propagate(reference.epoch + minutes[i] / 1440.0);
+        const double dx = check.X()[0] - expected[i][0], dy = check.Y()[0] - expected[i][1], dz = check.Z()[0] - expected[i][2];
+        worst = std::fmax(worst, std::sqrt(dx * dx + dy * dy + dz * dz));
+    }
+    std::printf("sgp4: reference satellite 00005, max deviation %.3g m over %g min\n", worst * 1000.0, minutes[3]);
+
+    std::vector<TwoLineElements> elements;
+    if (argc > 0 && !std::isdigit(static_cast<unsigned char>(argv[0][0]))) {
+        if (!LoadTwoLineElements(argv[0], elements)) {
+            std::printf("sgp4: failed to read %s\n", argv[0]);
+            return 1;
+        }
+    } else {
+        elements = makeSatellites(argc > 0 ? std::strtoull(argv[0], nullptr, 10) : 30000);
+    }
+    // 深空卫星没有SDP4项，不计入SGP4的批次，只报告数量
+    Sgp4Batch batch;
+    double epoch = 0.0;
+    size_t deepSpace = 0;
+    for (const TwoLineElements& tle : elements) {
+        if (Sgp4Batch::IsDeepSpace(tle)) {
+            deepSpace++;
+        } else if (batch.Add(tle)) {
+            epoch = std::fmax(epoch, tle.epoch);
+        }
+    }
+
+    // 每帧前进一分钟
+    ThreadPool pool;
+    const int frames = 200;
+    double seconds[2] = {};
+    double sum = 0.0;
+    for (int mode = 0; mode < 2; ++mode) {
+        auto start = std::chrono::steady_clock::now();
+        for (int frame = 0; frame < frames; ++frame) {
+            batch.Propagate(epoch + frame / 1440.0, mode == 0 ? nullptr : &pool);
+            sum += batch.X()[frame % batch.Size()];
+        }
+        seconds[mode] = secondsSince(start) / frames;
+    }
+    std::printf("  %zu near-Earth satellites (%zu deep-space left out, no SDP4): %.3f ms/frame single-threaded, %.3f ms/frame on the pool (%u threads, %.1f M satellites/s)\n",
+                batch.Size(), deepSpace, seconds[0] * 1000.0, seconds[1] * 1000.0, pool.Size(),
+                batch.Size() / seconds[1] / 1e6);
+    return (worst < 1.0 && sum != 12345.0) ? 0 : 1;
+}
+
+void usage()
+{
+    std::printf("usage: solar_bench gravity [N] [theta...]\n"
+                "       solar_bench wh [years] [stepDays]\n"
+                "       solar_bench determinism [N] [steps]\n"
+                "       solar_bench snapshot [N]\n"
+                "       solar_bench belt [N...]\n"
+                "       solar_bench ephemeris <file>\n"
+                "       solar_bench sgp4 [N | file]\n");
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    if (argc < 2) {
+        usage();
+        return benchGravity(0, nullptr);
+    }
+    if (std::strcmp(argv[1], "gravity") == 0) {
+        return benchGravity(argc - 2, argv + 2);
+    }
+    if (std::strcmp(argv[1], "wh") == 0) {
+        return benchWisdomHolman(argc - 2, argv + 2);
+    }
+    if (std::strcmp(argv[1], "determinism") == 0) {
+        return benchDeterminism(argc - 2, argv + 2);
+    }
+    if (std::strcmp(argv[1], "snapshot") == 0) {
+        return benchSnapshot(argc - 2, argv + 2);
+    }
+    if (std::strcmp(argv[1], "belt") == 0) {
+        return benchBelt(argc - 2, argv + 2);
+    }
+    if (std::strcmp(argv[1], "ephemeris") == 0) {
+        return benchEphemeris(argc - 2, argv + 2);
+    }
+    if (std::strcmp(argv[1], "sgp4") == 0) {
+        return benchSgp4(argc - 2, argv + 2);
+    }
+    usage();
+    return 1;
+}
@@ -0,0 +1,44 @@
+#ifndef ASTEROID_BELT_H
+#define ASTEROID_BELT_H
+
+#include <cstddef>
+#include <vector>
+#include "kepler.h"
+
+class ThreadPool;
+
+// 小天体带（主带、柯伊伯带等）
+// 每个小天体只受中心天体引力，沿固定的开普勒轨道运动，只保存轨道根数、平均角速度和历元平近点角，
+// 没有名称、纹理和轨迹。位置是时间的解析函数，求解时直接由时间算出平近点角，不需要逐步推进，
+// 也不需要在两个模拟步之间插值
+class AsteroidBelt {
+public:
+    // gravity为中心天体的引力参数 G*M（场景单位）
+    explicit AsteroidBelt(double gravity = 1.0);
+
+    // 在半长轴[innerRadius, outerRadius]内均匀随机生成count个小天体，偏心率和倾角（弧度）不超过给定上限
+    // 固定的seed保证每次生成相同的分布
+    void AddRing(size_t count, float innerRadius, float outerRadius,
+                 float maxEccentricity, float maxInclination, unsigned int seed);
+
+    void Clear();
+    size_t Size() const { return orbits.Size(); }
+
+    // 求解time时刻所有小天体的位置，以xyz交错写入out（3 * Size()个float）
+    // 位置为中心天体坐标加上(originX, originY, originZ)，传入中心天体相对于相机的位置即得到绘制坐标；
+    // 给出线程池时按块并行，每块先算平近点角再求解，数据在缓存中只走一遍
+    void Evaluate(double time, float originX, float originY, float originZ, float* out, ThreadPool* pool = nullptr);
+
+private:
+    // 处理[begin, end)范围内的小天体
+    void EvaluateRange(double time, float originX, float originY, float originZ, float* out, size_t begin, size_t end);
+
+    double gravity;
+
+    KeplerBatch orbits;
+    std::vector<double> meanMotion;      // 平均角速度 n = sqrt(GM / a^3)
+    std::vector<double> epochAnomaly;    // 历元平近点角
+    std::vector<float> meanAnomaly;      // 本次求解的平近点角
+};
+
+#endif // ASTEROID_BELT_H
@@ -0,0 +1,75 @@
+#ifndef BARNES_HUT_H
+#define BARNES_HUT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+class ThreadPool;
+
+// Barnes-Hut八叉树引力求解器
+// 每次构建先按Morton码（每轴21位）对天体排序，八叉树的每个节点对应排序后数组中的一段连续区间，
+// 节点存放在一个扁平数组中，同一节点的子节点相邻。求加速度时远处的节点按质心加四极矩近似，
+// 节点边长与距离之比小于张角θ即视为足够远。
+// 遍历以不超过GROUP_SIZE个天体的子树为一组：整组共用一次遍历得到的相互作用列表（单元与组包围盒相交的节点总是打开，
+// 其余按质心到组包围盒的最近距离判断），
+// 再对组内每个天体扫描列表，内层循环可以向量化
+class BarnesHutTree {
+public:
+    // 叶节点最多包含的天体数
+    static const unsigned int LEAF_SIZE = 8;
+
+    // 共用一次遍历的天体组的最大大小
+    static const unsigned int GROUP_SIZE = 32;
+
+    // 由天体位置和质量构建八叉树；Morton码、排序和数据重排按块并行
+    void Build(const double* x, const double* y, const double* z, const double* mass, size_t count, ThreadPool* pool);
+
+    // 计算所有天体的加速度（按原始编号写入），返回计算的相互作用次数
+    unsigned long long Accelerations(double theta, double gravity, double softening2,
+                                     double* ax, double* ay, double* az, ThreadPool* pool) const;
+
+    size_t NodeCount() const { return nodes.size(); }
+
+private:
+    struct Node {
+        double x, y, z;          // 质心
+        double mass;             // 总质量
+        double quadrupole[6];    // 关于质心的四极矩 Σm(3rr - r²I)：xx, yy, zz, xy, xz, yz
+        double corner[3];        // 单元的最小角
+        double size;             // 单元边长
+        double size2;            // 节点边长的平方
+        unsigned int first;      // 在排序后数组中的起点
+        unsigned int count;      // 包含的天体数
+        int firstChild;          // 第一个子节点，-1表示叶节点
+        int childCount;          // 非空子节点数
+    };
+
+    // 一组天体共用的相互作用列表（SoA）
+    struct InteractionList {
+        std::vector<double> x, y, z, mass;   // 节点质心或单个天体
+        std::vector<double> q[6];            // 节点的四极矩，单个天体不使用
+        size_t nodes;                        // 前nodes项是节点，其余是天体
+        std::vector<unsigned int> leaves;    // 遍历时暂存的叶节点，随列表在线程内复用
+        void Clear();
+        void Add(double px, double py, double pz, double m);
+    };
+
+    // 递归构建节点，子节点连续分配在nodes末尾；corner和size为单元的最小角和边长，inGroup表示祖先已经是一个组
+    void BuildNode(int index, unsigned int first, unsigned int count, int level, const double* corner, double size, bool inGroup);
+
+    // 把质量m、相对质心偏移(dx, dy, dz)的点（或子节点）的四极矩贡献加到q上
+    static void AddQuadrupole(double* q, double m, double dx, double dy, double dz);
+
+    // 为一组天体收集相互作用列表
+    void Walk(const Node& group, double theta2, InteractionList& list) const;
+
+    std::vector<std::pair<uint64_t, uint32_t>> keys;  // (Morton码, 原始编号)，排序后
+    std::vector<std::pair<uint64_t, uint32_t>> scratch;
+    std::vector<double> sx, sy, sz, sm;               // 按排序后顺序存放的位置和质量
+    std::vector<Node> nodes;
+    std::vector<int> groups;                          // 每组的根节点
+};
+
+#endif // BARNES_HUT_H
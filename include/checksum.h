@@ -0,0 +1,26 @@
+#ifndef CHECKSUM_H
+#define CHECKSUM_H
+
+#include <cstddef>
+#include <cstdint>
+
+// 模拟状态的64位校验和（FNV-1a），按浮点数的二进制位计算
+// 用于比较两次运行是否逐位一致：同样的初始状态、步长和步数应当得到同样的校验和
+class StateChecksum {
+public:
+    StateChecksum();
+
+    // 依次加入一组数值，顺序不同结果也不同
+    void Add(const double* values, size_t count);
+    void Add(const float* values, size_t count);
+    void Add(uint64_t value);
+
+    uint64_t Value() const { return hash; }
+
+private:
+    void AddBytes(const void* data, size_t size);
+
+    uint64_t hash;
+};
+
+#endif // CHECKSUM_H
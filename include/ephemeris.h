@@ -0,0 +1,104 @@
+#ifndef EPHEMERIS_H
+#define EPHEMERIS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "mapped_file.h"
+
+// 切比雪夫星历文件的二进制格式（仿照JPL DE星历）
+// 时间轴按固定长度切成若干段，每段是一条定长记录；记录中每个天体占一块，
+// 把本段再等分为subintervals个子区间，每个子区间对x、y、z各有coefficients个切比雪夫系数，
+// 按 [子区间][分量][系数] 顺序排列。位置为日心黄道坐标（J2000），单位AU，时间为儒略日。
+// 以本机字节序原样保存，格式变化时递增EPHEMERIS_VERSION
+const uint32_t EPHEMERIS_VERSION = 1;
+const size_t EPHEMERIS_ALIGNMENT = 64;
+const size_t EPHEMERIS_NAME_LENGTH = 16;
+
+struct EphemerisHeader {
+    char magic[8];              // "SOLAREPH"
+    uint32_t version;           // EPHEMERIS_VERSION
+    uint32_t byteOrder;         // 0x01020304，用于识别字节序不同的机器写出的文件
+    uint64_t fileSize;          // 整个文件的字节数
+    double startDay;            // 第一段的起始儒略日
+    double segmentDays;         // 每段的天数
+    uint64_t segmentCount;      // 段数
+    uint32_t bodyCount;         // 天体数
+    uint32_t segmentDoubles;    // 每段记录的double个数
+    uint64_t bodiesOffset;      // 天体表的起始位置
+    uint64_t segmentsOffset;    // 第一段记录的起始位置
+};
+
+// 天体表中的一项
+struct EphemerisBody {
+    char name[EPHEMERIS_NAME_LENGTH];   // 以'\0'结尾的名称
+    uint32_t coefficients;              // 每个分量的系数个数（多项式阶数 + 1）
+    uint32_t subintervals;              // 每段分成的子区间数
+    uint32_t offset;                    // 在段记录中的起始位置（以double计）
+    uint32_t reserved;
+};
+
+// 按顺序为天体分配在段记录中的位置（填写offset），返回每段记录的double个数
+uint32_t LayoutEphemerisBodies(std::vector<EphemerisBody>& bodies);
+
+// 写出星历文件，segments为segmentCount条依次排列的段记录，失败时返回false
+bool WriteEphemeris(const char* path, double startDay, double segmentDays,
+                    const std::vector<EphemerisBody>& bodies, const std::vector<double>& segments);
+
+// 切比雪夫星历读取器
+// 文件按需映射（不预读），只有用到的段才会从磁盘载入。段记录第一次用到时拷贝到缓存中，
+// 最近使用的CACHE_SEGMENTS段保留在缓存里（LRU），之后的查询只是一次多项式求值；
+// 在几个世纪之间来回跳转时，缓存中的段不会再访问映射内存，被系统换出的页面也不会重复读盘
+class Ephemeris {
+public:
+    static const size_t CACHE_SEGMENTS = 32;
+
+    Ephemeris();
+
+    // 映射并校验文件，格式或版本不符时返回false
+    bool Open(const char* path);
+
+    void Close();
+
+    bool IsOpen() const { return header != nullptr; }
+    size_t BodyCount() const { return header != nullptr ? header->bodyCount : 0; }
+    const char* BodyName(size_t body) const { return bodies[body].name; }
+
+    // 按名称查找天体，找不到时返回-1
+    int FindBody(const char* name) const;
+
+    // 覆盖的时间范围（儒略日）
+    double StartDay() const;
+    double EndDay() const;
+
+    // 天体在儒略日day的日心位置（AU），day超出文件范围时返回false
+    bool Position(size_t body, double day, double position[3]);
+
+    // 缓存统计
+    uint64_t CacheHits() const { return hits; }
+    uint64_t CacheMisses() const { return misses; }
+
+private:
+    // 缓存中的一段
+    struct CacheSlot {
+        uint64_t segment;               // 段编号
+        uint64_t lastUsed;              // 最近一次使用的时刻，用于淘汰
+        bool valid;
+        std::vector<double> coefficients;
+    };
+
+    // 取得第segment段的系数，不在缓存中时从映射内存拷贝并淘汰最久未用的一段
+    const double* Segment(uint64_t segment);
+
+    MappedFile file;
+    const EphemerisHeader* header;
+    const EphemerisBody* bodies;
+
+    std::vector<CacheSlot> cache;
+    size_t lastSlot;    // 上一次命中的缓存位置，逐帧查询时通常仍是它
+    uint64_t clock;
+    uint64_t hits;
+    uint64_t misses;
+};
+
+#endif // EPHEMERIS_H
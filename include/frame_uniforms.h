@@ -0,0 +1,37 @@
+#ifndef FRAME_UNIFORMS_H
+#define FRAME_UNIFORMS_H
+
+#include <glm/glm.hpp>
+#include <GL/glew.h>
+
+// FrameData uniform块的绑定点，所有着色器程序在链接时绑定到这里
+const GLuint FRAME_UNIFORM_BINDING = 0;
+
+// 每帧共享的着色器数据，内存布局与着色器中的std140 uniform块一致
+// 所有顶点都以相对于相机的坐标提交，视图矩阵只包含旋转，相机位于原点
+struct FrameData {
+    glm::mat4 view;          // 视图矩阵（只含旋转）
+    glm::mat4 projection;    // 透视投影矩阵
+    glm::mat4 screen;        // 屏幕空间正交投影（用于文字）
+    glm::vec4 lightPos;      // xyz: 光源相对于相机的位置
+    glm::vec4 lightColor;    // xyz: 光源颜色, w: 环境光强度
+    glm::vec4 viewPos;       // xyz: 相机位置（恒为原点）
+};
+
+// 管理FrameData对应的uniform缓冲区
+class FrameUniforms {
+public:
+    FrameUniforms();
+    ~FrameUniforms();
+
+    // 上传本帧数据，每帧调用一次
+    void Update(const FrameData& data);
+
+    // 将程序中的FrameData块绑定到固定绑定点（程序中没有该块时忽略）
+    static void Attach(GLuint program);
+
+private:
+    GLuint UBO;
+};
+
+#endif // FRAME_UNIFORMS_H
@@ -0,0 +1,23 @@
+#ifndef FRUSTUM_H
+#define FRUSTUM_H
+
+#include <glm/glm.hpp>
+
+// 视锥体，由投影矩阵与视图矩阵的乘积提取出6个裁剪平面
+class Frustum {
+public:
+    Frustum();
+    explicit Frustum(const glm::mat4& viewProjection);
+
+    // 包围球是否与视锥体相交
+    bool IntersectsSphere(const glm::vec3& center, float radius) const;
+
+    // 轴对齐包围盒是否与视锥体相交
+    bool IntersectsBox(const glm::vec3& boxMin, const glm::vec3& boxMax) const;
+
+private:
+    // 平面方程 (a, b, c, d)，法线朝向视锥体内部并已归一化
+    glm::vec4 planes[6];
+};
+
+#endif // FRUSTUM_H
@@ -0,0 +1,86 @@
+#ifndef KEPLER_H
+#define KEPLER_H
+
+#include <cstddef>
+#include <vector>
+
+class ThreadPool;
+
+// 开普勒轨道根数，角度为弧度，参考平面为黄道
+struct OrbitalElements {
+    float semiMajorAxis;        // 半长轴 a（场景单位）
+    float eccentricity;         // 偏心率 e，需小于1
+    float inclination;          // 轨道倾角 i
+    float ascendingNode;        // 升交点黄经 Ω
+    float argumentOfPeriapsis;  // 近点幅角 ω
+    float meanAnomalyAtEpoch;   // 历元平近点角 M0
+};
+
+// 批量开普勒方程求解器
+// 轨道数据按分量分开存放（SoA），内层循环没有分支，编译器可以把连续的多个天体放进同一组SIMD通道。
+// 每个天体的轨道平面预先折算为两个基向量P、Q（已乘以a和b），求解偏近点角E后
+//   位置 = P * (cos E - e) + Q * sin E
+// 输出为场景坐标：黄道 (x, y, z) 映射为场景 (x, z, -y)，Y轴朝上
+class KeplerBatch {
+public:
+    // 每次迭代的Halley步数（从Danby初值出发，e < 0.95时足以收敛到float精度）
+    static const int HALLEY_ITERATIONS = 3;
+
+    // 添加一个天体，返回它在批次中的编号
+    size_t Add(const OrbitalElements& elements);
+
+    void Clear();
+    size_t Size() const { return eccentricity.size(); }
+
+    // 由每个天体当前的平近点角求解位置；给出线程池时按块并行
+    void Solve(const float* meanAnomaly, ThreadPool* pool = nullptr);
+
+    // 只求解[begin, end)范围内的天体
+    void Solve(const float* meanAnomaly, size_t begin, size_t end);
+
+    // 求解结果（相对于各自的中心天体）
+    const float* X() const { return x.data(); }
+    const float* Y() const { return y.data(); }
+    const float* Z() const { return z.data(); }
+
+private:
+    std::vector<float> eccentricity;
+    std::vector<float> px, py, pz;  // 近点方向，乘以a
+    std::vector<float> qx, qy, qz;  // 半通径方向，乘以b
+    std::vector<float> x, y, z;     // 输出位置
+};
+
+// 双精度批量开普勒方程求解器，接口与KeplerBatch相同
+// 用于数量少、离中心天体远的天体（场景中的行星）：float的平近点角在π附近的分辨率约为2.4e-7弧度，
+// 位置分量的舍入误差也与轨道半径成正比，几十个AU的轨道上每步都会跳动，拉近相机时可以看出来。
+// 这里平近点角、基向量和输出都是double，正弦余弦用标准库
+class PreciseKeplerBatch {
+public:
+    // 每次求解的Halley步数（从Danby初值出发，e < 0.95时足以收敛到double精度）
+    static const int HALLEY_ITERATIONS = 5;
+
+    size_t Add(const OrbitalElements& elements);
+
+    void Clear();
+    size_t Size() const { return eccentricity.size(); }
+
+    void Solve(const double* meanAnomaly);
+
+    const double* X() const { return x.data(); }
+    const double* Y() const { return y.data(); }
+    const double* Z() const { return z.data(); }
+
+private:
+    std::vector<double> eccentricity;
+    std::vector<double> px, py, pz;
+    std::vector<double> qx, qy, qz;
+    std::vector<double> x, y, z;
+};
+
+// 批量f/g函数开普勒漂移（双精度）
+// 每个天体在同一中心引力参数mu下沿二体轨道前进dt，原地更新位置和速度。
+// 偏近点角的增量用固定次数的Halley迭代求解，循环内没有分支。只适用于椭圆轨道
+void KeplerDrift(double* x, double* y, double* z, double* vx, double* vy, double* vz,
+                 size_t count, double mu, double dt);
+
+#endif // KEPLER_H
@@ -0,0 +1,32 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <cstddef>
+
+// 只读内存映射文件
+// 文件内容按需由操作系统分页载入，读取方直接使用映射内存中的数据，不需要解析和拷贝
+class MappedFile {
+public:
+    MappedFile();
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // 映射整个文件，失败时返回false（之前映射的文件会先关闭）
+    // populate为true时一次性载入所有页面；为false时按需载入，并提示系统按随机访问处理（不预读），适合只访问一小部分的大文件
+    bool Open(const char* path, bool populate = true);
+
+    // 解除映射
+    void Close();
+
+    bool IsOpen() const { return data != nullptr; }
+    const unsigned char* Data() const { return static_cast<const unsigned char*>(data); }
+    size_t Size() const { return size; }
+
+private:
+    void* data;
+    size_t size;
+};
+
+#endif // MAPPED_FILE_H
@@ -0,0 +1,92 @@
+#ifndef NBODY_H
+#define NBODY_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "barnes_hut.h"
+
+class ThreadPool;
+
+// 引力的计算方式
+enum class GravitySolver {
+    Direct,     // 直接求和，O(N²)，精确
+    BarnesHut   // 八叉树近似，O(N log N)
+};
+
+// 引力N体系统
+// 状态按分量分开存放（SoA），用KDK蛙跳（速度Verlet）积分，辛结构保证长期能量误差有界。
+// 直接求和的引力核把i按固定宽度LANES分组，每组同时对所有j累加；
+// 累加顺序与线程数无关，结果可复现。天体很多时可以改用Barnes-Hut八叉树
+class NBodySystem {
+public:
+    // 引力核每组同时处理的天体数
+    static const size_t LANES = 8;
+
+    // gravity: 引力常数G；softening: 软化长度，避免近距离相遇时加速度发散
+    explicit NBodySystem(double gravity = 1.0, double softening = 0.0);
+
+    // 添加一个天体，返回编号
+    size_t Add(double mass, double x, double y, double z, double vx, double vy, double vz);
+
+    // 用已有的状态整体替换所有天体（例如从快照恢复），各数组长度为count
+    void Assign(size_t count, const double* x, const double* y, const double* z,
+                const double* vx, const double* vy, const double* vz, const double* mass);
+
+    void Clear();
+    size_t Size() const { return count; }
+
+    double Gravity() const { return gravity; }
+    double Softening() const { return softening; }
+
+    // 选择引力求解方式，theta为Barnes-Hut的张角
+    void SetSolver(GravitySolver solver, double theta = 0.5);
+    GravitySolver Solver() const { return solver; }
+    double Theta() const { return theta; }
+
+    // 积分一步：v += a dt/2; x += v dt; 重新计算a; v += a dt/2
+    void Step(double dt, ThreadPool* pool = nullptr);
+
+    // 总能量（动能 + 势能），O(N²)，用于检查积分误差
+    double Energy() const;
+
+    // 位置和速度的64位校验和，用于比较不同运行（线程数、机器）的结果是否逐位一致
+    uint64_t Checksum() const;
+
+    // 累计计算过的天体对数
+    unsigned long long Interactions() const { return interactions; }
+
+    const double* X() const { return x.data(); }
+    const double* Y() const { return y.data(); }
+    const double* Z() const { return z.data(); }
+    const double* VX() const { return vx.data(); }
+    const double* VY() const { return vy.data(); }
+    const double* VZ() const { return vz.data(); }
+    const double* Mass() const { return mass.data(); }
+
+private:
+    // 重新计算所有天体的加速度
+    void ComputeAccelerations(ThreadPool* pool);
+
+    // 计算[begin, end)内各组天体的加速度，begin和end是LANES的整数倍
+    void AccelerationKernel(size_t begin, size_t end);
+
+    double gravity;
+    double softening;
+    double softening2;
+
+    GravitySolver solver;
+    double theta;
+    BarnesHutTree tree;
+
+    size_t count;                       // 实际天体数，数组长度补齐到LANES的整数倍（补齐部分质量为0）
+    bool accelerationsValid;            // 加速度是否与当前位置对应
+    unsigned long long interactions;
+
+    std::vector<double> x, y, z;
+    std::vector<double> vx, vy, vz;
+    std::vector<double> ax, ay, az;
+    std::vector<double> mass;
+};
+
+#endif // NBODY_H
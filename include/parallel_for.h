@@ -0,0 +1,54 @@
+#ifndef PARALLEL_FOR_H
+#define PARALLEL_FOR_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// 固定线程数的线程池，只提供并行for
+// 区间按固定粒度切块，块的划分与线程数无关；调用线程也参与计算。
+// ParallelFor不可重入，也不能从多个线程同时调用
+class ThreadPool {
+public:
+    // threads为参与计算的线程总数（含调用线程），0表示使用硬件线程数
+    explicit ThreadPool(unsigned int threads = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // 参与计算的线程总数
+    unsigned int Size() const { return static_cast<unsigned int>(workers.size()) + 1; }
+
+    // 把[begin, end)按grain切块，并行调用fn(chunkBegin, chunkEnd)，全部完成后返回
+    void ParallelFor(size_t begin, size_t end, size_t grain, const std::function<void(size_t, size_t)>& fn);
+
+private:
+    // 工作线程主循环
+    void WorkerLoop();
+
+    // 领取并执行当前任务的块，直到没有剩余
+    void RunChunks();
+
+    std::vector<std::thread> workers;
+
+    std::mutex mutex;
+    std::condition_variable wake;   // 有新任务或要退出
+    std::condition_variable done;   // 所有工作线程完成当前任务
+
+    // 当前任务
+    const std::function<void(size_t, size_t)>* job;
+    size_t jobEnd;
+    size_t jobGrain;
+    std::atomic<size_t> next;       // 下一个待领取的块起点
+
+    unsigned int generation;        // 任务编号，变化时唤醒工作线程
+    unsigned int busy;              // 尚未完成当前任务的工作线程数
+    bool stopping;
+};
+
+#endif // PARALLEL_FOR_H
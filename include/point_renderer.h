@@ -0,0 +1,37 @@
+#ifndef POINT_RENDERER_H
+#define POINT_RENDERER_H
+
+#include <cstddef>
+#include <glm/glm.hpp>
+#include <GL/glew.h>
+
+// 流式点渲染器，用于碎片等大量小天体
+// 每批点以不同步映射的方式追加到缓冲区中尚未使用的部分，GPU可能仍在读取的部分不会被覆盖；
+// 缓冲区写满时才孤立（orphan）旧存储从头开始，一帧中的几次小批量绘制不会每次都重新分配大缓冲区
+class PointRenderer {
+public:
+    PointRenderer();
+    ~PointRenderer();
+
+    // 上传并一次绘制count个相对于相机的点（视图和投影矩阵来自FrameData uniform块）
+    void Draw(const glm::vec3* points, size_t count, const glm::vec3& color, float size);
+
+private:
+    // 着色器程序
+    GLuint shader;
+
+    // 链接时查询好的uniform位置
+    GLint colorLocation;
+    GLint sizeLocation;
+
+    // 缓冲区当前能容纳的点数
+    size_t capacity;
+
+    // 下一批点的写入位置（点数）
+    size_t offset;
+
+    // VAO和VBO
+    GLuint VAO, VBO;
+};
+
+#endif // POINT_RENDERER_H
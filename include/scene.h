@@ -0,0 +1,105 @@
+#ifndef SCENE_H
+#define SCENE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "mapped_file.h"
+
+// 场景描述：文本文件中按块列出天体，第一次读取时编译成二进制缓存，之后直接映射缓存
+//
+// 文本格式：每个天体以"body 名称"开始，之后每行一个"键 值"，直到下一个body；#之后为注释
+//   body Earth
+//       parent Sun              中心天体的名称，省略时为层级的根（场景中只能有一个根）
+//       radius 1.3              半径（场景单位）
+//       distance 10.75          轨道半长轴
+//       eccentricity 0.0167
+//       inclination 0           角度均为度
+//       ascendingNode -11.261
+//       argumentOfPeriapsis 114.208
+//       meanAnomaly -1.383      历元平近点角
+//       mass 3.003e-6           太阳质量，N体模式使用
+//       orbitSpeed 3.0          基础公转速度
+//       rotationSpeed 1.0       基础自转速度
+//       tilt 23.4               轴倾角
+//       texture texture/earth.jpg
+//       emissive 0              是否自发光
+//       trail 1                 是否绘制轨迹
+// 省略的数值为0（trail默认为1），texture不能省略。数值必须有限，radius为正，eccentricity在[0, 1)内，
+// mass非负，根天体的mass和其余天体的distance必须为正。
+//
+// 缓存文件以本机字节序原样保存定长的天体记录，记下源文件的大小和修改时间；
+// 二者都不变时认为缓存有效。格式变化时递增SCENE_VERSION
+const uint32_t SCENE_VERSION = 1;
+const size_t SCENE_ALIGNMENT = 64;
+const size_t SCENE_NAME_LENGTH = 32;
+const size_t SCENE_TEXTURE_LENGTH = 96;
+
+// 天体标志位
+const uint32_t SCENE_BODY_EMISSIVE = 1u << 0;
+const uint32_t SCENE_BODY_TRAIL = 1u << 1;
+
+// 缓存中的一个天体，字段与Planet的同名字段对应
+struct SceneBody {
+    char name[SCENE_NAME_LENGTH];           // 以'\0'结尾
+    char texture[SCENE_TEXTURE_LENGTH];     // 以'\0'结尾
+    int32_t parent;                         // 中心天体在天体表中的编号，-1表示根
+    uint32_t flags;                         // SCENE_BODY_*
+    float radius;
+    float distance;
+    float eccentricity;
+    float inclination;
+    float ascendingNode;
+    float argumentOfPeriapsis;
+    float meanAnomaly;
+    float mass;
+    float orbitSpeed;
+    float rotationSpeed;
+    float tilt;
+    float reserved;
+};
+
+struct SceneHeader {
+    char magic[8];              // "SOLARSCN"
+    uint32_t version;           // SCENE_VERSION
+    uint32_t byteOrder;         // 0x01020304，用于识别字节序不同的机器写出的文件
+    uint64_t fileSize;          // 整个文件的字节数
+    uint64_t sourceSize;        // 编译时源文件的字节数
+    int64_t sourceModified;     // 编译时源文件的修改时间（纳秒）
+    uint64_t bodyCount;         // 天体数
+    uint64_t bodiesOffset;      // 天体表的起始位置
+    uint32_t recordSize;        // sizeof(SceneBody)
+    uint32_t reserved;
+};
+
+// 解析场景文本，出错时返回false，error中给出行号和原因
+bool ParseSceneText(const char* path, std::vector<SceneBody>& bodies, std::string& error);
+
+// 写出场景缓存，失败时返回false
+bool WriteSceneCache(const char* path, const std::vector<SceneBody>& bodies, uint64_t sourceSize, int64_t sourceModified);
+
+// 场景读取器
+class Scene {
+public:
+    // 读取场景：缓存（源文件名加".cache"）与源文件一致时直接映射，否则解析源文件并重新写出缓存。
+    // 缓存无法写出时仍使用解析结果；源文件不存在但有缓存时使用缓存。失败时返回false并给出原因
+    bool Load(const char* sourcePath, std::string& error);
+
+    size_t Size() const;
+    const SceneBody* Bodies() const;
+
+    // 本次是否解析了源文件（false表示直接使用了缓存）
+    bool Compiled() const { return compiled; }
+
+private:
+    // 映射并校验缓存文件的格式，记录须满足与解析结果相同的约定（单一的根、纹理、根的质量等）
+    bool OpenCache(const std::string& path);
+
+    MappedFile file;
+    const SceneHeader* header = nullptr;
+    std::vector<SceneBody> parsed;      // 缓存无法写出时的解析结果
+    bool compiled = false;
+};
+
+#endif // SCENE_H
@@ -0,0 +1,85 @@
+#ifndef SGP4_H
+#define SGP4_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+class ThreadPool;
+
+// 两行根数（TLE）中SGP4用到的量，角度为弧度
+struct TwoLineElements {
+    std::string name;           // 三行格式中的名称行，两行格式时为空
+    int catalogNumber;          // NORAD编号
+    double epoch;               // 历元（儒略日，UTC）
+    double bstar;               // 阻力系数B*（1/地球半径）
+    double inclination;         // 倾角
+    double ascendingNode;       // 升交点赤经
+    double eccentricity;        // 偏心率
+    double argumentOfPerigee;   // 近地点幅角
+    double meanAnomaly;         // 平近点角
+    double meanMotion;          // 平均运动（弧度/分钟，TLE中的Kozai平均值）
+};
+
+// 按固定列宽解析一组两行根数，格式不对时返回false（不检查校验位）
+bool ParseTwoLineElements(const std::string& line1, const std::string& line2, TwoLineElements& elements);
+
+// 读取TLE文件（两行或带名称行的三行格式），无法解析的行跳过；文件无法打开时返回false
+bool LoadTwoLineElements(const char* path, std::vector<TwoLineElements>& elements);
+
+// 批量SGP4传播器（近地部分，WGS-72常数，与Vallado等人2006年修订版的sgp4一致）
+// 添加卫星时一次算好每颗卫星的长期项系数，按分量分开存放（SoA）；传播时每颗卫星的计算完全相同：
+// 近地点低于220 km的简化模型通过把高阶系数置零合并进同一组公式，开普勒方程用固定次数的牛顿迭代，
+// sin/cos用无分支的多项式，内层循环没有分支和库函数调用，编译器可以把多颗卫星放进同一组SIMD通道。
+// 周期不短于225分钟的深空卫星（GPS、地球同步、闪电轨道等）需要SDP4的日月摄动和共振项，这里没有实现，
+// 默认不接受它们。构造时打开approximateDeepSpace的批次只用于深空卫星：按近地公式（简化模型）传播，
+// 位置误差随离开历元的时间增长，几天后可达上千公里，结果只能作为近似位置单独标出，不能当作SGP4的结果
+class Sgp4Batch {
+public:
+    // 开普勒方程的牛顿迭代次数，与参考实现的上限相同
+    static const int KEPLER_ITERATIONS = 10;
+
+    explicit Sgp4Batch(bool approximateDeepSpace = false) : approximate(approximateDeepSpace) {}
+
+    // 是否为深空卫星（去掉Kozai平均后的周期不短于225分钟）
+    static bool IsDeepSpace(const TwoLineElements& elements);
+
+    // 添加一颗卫星，根数无效（偏心率不在[0, 1)、平均运动不为正或近地点在地面以下）时不添加并返回false；
+    // 深空卫星只有近似批次才接受
+    bool Add(const TwoLineElements& elements);
+
+    void Clear();
+    size_t Size() const { return epoch.size(); }
+
+    // 按近地公式近似传播的深空卫星数（见类说明），默认批次中总为0
+    size_t DeepSpaceCount() const { return deepSpace; }
+
+    // 传播到儒略日day（UTC）；给出线程池时按块并行
+    void Propagate(double day, ThreadPool* pool = nullptr);
+
+    // 只传播[begin, end)范围内的卫星
+    void Propagate(double day, size_t begin, size_t end);
+
+    // 传播结果：TEME坐标（地心，真赤道平春分点），单位km；已坠入大气或轨道发散的卫星为原点
+    const double* X() const { return x.data(); }
+    const double* Y() const { return y.data(); }
+    const double* Z() const { return z.data(); }
+
+private:
+    std::vector<double> epoch;                      // 历元（儒略日）
+    std::vector<double> meanAnomaly, meanAnomalyRate;
+    std::vector<double> perigee, perigeeRate;       // 近地点幅角及其变化率
+    std::vector<double> node, nodeRate, nodeDrag;   // 升交点及其变化率，nodecf
+    std::vector<double> cc1, cc4, cc5;              // 阻力系数（cc4、cc5已乘以B*）
+    std::vector<double> t2cof, t3cof, t4cof, t5cof; // 平经度的时间多项式系数
+    std::vector<double> d2, d3, d4;                 // 半长轴衰减的时间多项式系数
+    std::vector<double> omgcof, xmcof, eta, delmo, sinmao;
+    std::vector<double> eccentricity, inclination, sinInclination, cosInclination;
+    std::vector<double> semiMajorAxis, meanMotion;  // 去掉Kozai平均后的历元半长轴（地球半径）和平均运动
+    std::vector<double> aycof, xlcof, con41, x1mth2, x7thm1;
+    std::vector<double> x, y, z;                    // 输出位置
+    size_t deepSpace = 0;
+    bool approximate;                               // 是否接受深空卫星并近似传播
+};
+
+#endif // SGP4_H
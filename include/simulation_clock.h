@@ -0,0 +1,49 @@
+#ifndef SIMULATION_CLOCK_H
+#define SIMULATION_CLOCK_H
+
+// 固定步长的模拟时钟
+// 每帧把真实经过的时间乘以时间倍率放进累加器，再按步长消耗；剩余的部分作为渲染插值系数。
+// 模拟时间只由步数和步长决定，与帧率无关
+class SimulationClock {
+public:
+    // step: 每个模拟步长（模拟秒）；maxFrameTime: 单帧最多计入的真实时间，防止卡顿后追赶过多步
+    explicit SimulationClock(double step, double maxFrameTime = 0.25);
+
+    // 计入一帧经过的真实时间（秒），按时间倍率换算为模拟时间
+    void Advance(double frameTime);
+
+    // 如果累加器够一个步长就消耗它并返回true，调用方随后推进一步模拟
+    bool Step();
+
+    // 丢弃累加器中剩余的整步（本帧的计算预算用完时调用），只保留插值用的零头
+    void Drop();
+
+    // 上一个与当前模拟状态之间的插值系数，范围[0, 1)
+    float Alpha() const;
+
+    // 修改步长，下一次Step起生效
+    void SetStepSize(double step);
+    double StepSize() const { return step; }
+
+    // 时间倍率：每真实秒推进的模拟秒数
+    void SetWarp(double warp);
+    double Warp() const { return warp; }
+
+    // 恢复到已执行steps步、已模拟time秒的状态（例如读取快照后），累加器清零
+    void Restore(unsigned long long steps, double time);
+
+    unsigned long long Steps() const { return steps; }
+
+    // 已模拟的时间（秒）
+    double Time() const { return time; }
+
+private:
+    double step;                // 当前步长
+    double maxFrameTime;        // 单帧计入时间上限
+    double warp;                // 时间倍率
+    double accumulator;         // 尚未消耗的模拟时间
+    double time;                // 已模拟的时间
+    unsigned long long steps;   // 已执行的步数
+};
+
+#endif // SIMULATION_CLOCK_H
@@ -0,0 +1,112 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "mapped_file.h"
+
+// 模拟状态快照的二进制格式
+// 文件头之后依次是运动学天体的角度段和N体状态段，每段按SNAPSHOT_ALIGNMENT对齐，
+// 以本机字节序原样保存数组，读取时直接指向映射内存。格式变化时递增SNAPSHOT_VERSION
+const uint32_t SNAPSHOT_VERSION = 4;
+const size_t SNAPSHOT_ALIGNMENT = 64;
+
+// 快照标志位
+const uint32_t SNAPSHOT_NBODY = 1u << 0;        // 处于N体模式
+const uint32_t SNAPSHOT_BARNES_HUT = 1u << 1;   // N体引力使用Barnes-Hut
+
+struct SnapshotHeader {
+    char magic[8];          // "SOLARSNP"
+    uint32_t version;       // SNAPSHOT_VERSION
+    uint32_t byteOrder;     // 0x01020304，用于识别字节序不同的机器写出的文件
+    uint64_t fileSize;      // 整个文件的字节数
+    uint32_t flags;         // SNAPSHOT_*标志
+    uint32_t reserved;
+    uint64_t steps;         // 已执行的模拟步数
+    double time;            // 已模拟的时间
+    uint64_t bodyCount;     // 运动学天体数
+    uint64_t anglesOffset;  // 角度段：公转角[bodyCount]（double）、自转角[bodyCount]（float）
+    uint64_t nbodyCount;    // N体天体数
+    uint64_t nbodyOffset;   // N体段：x, y, z, vx, vy, vz, mass 各nbodyCount个double
+    double gravity;         // N体引力常数
+    double softening;       // N体软化长度
+    double theta;           // Barnes-Hut张角
+    double orbitTime;       // 轨道时间（小天体带和星历按它求位置）
+    uint64_t sceneHash;     // 写出时场景层级（各天体的中心天体编号）的哈希，恢复时必须一致
+};
+
+// 待写出的模拟状态，由调用方在帧循环中拷贝一份后交给SnapshotWriter
+struct SnapshotData {
+    uint32_t flags = 0;
+    uint64_t steps = 0;
+    double time = 0.0;
+    std::vector<double> orbitAngles;
+    std::vector<float> rotationAngles;
+    double gravity = 0.0;
+    double softening = 0.0;
+    double theta = 0.0;
+    double orbitTime = 0.0;
+    uint64_t sceneHash = 0;
+    size_t nbodyCount = 0;
+    std::vector<double> nbodyState;     // 7个分量依次排列，每个分量nbodyCount个
+};
+
+// 后台写快照
+// 文件先写到临时文件再改名，写入过程中程序崩溃也不会留下损坏的快照
+class SnapshotWriter {
+public:
+    SnapshotWriter();
+    ~SnapshotWriter();
+
+    SnapshotWriter(const SnapshotWriter&) = delete;
+    SnapshotWriter& operator=(const SnapshotWriter&) = delete;
+
+    // 提交一次保存，立即返回；上一次保存尚未完成时返回false
+    bool Save(const std::string& path, SnapshotData&& data);
+
+    // 是否有保存正在进行
+    bool Busy();
+
+    // 取回上一次保存用过的数据（已清空，保留容量），下次保存时重复使用，避免重新分配内存和缺页
+    SnapshotData Recycle();
+
+private:
+    void WorkerLoop();
+
+    // 在后台线程中写出文件
+    static bool Write(const std::string& path, const SnapshotData& data);
+
+    std::thread worker;
+    std::mutex mutex;
+    std::condition_variable wake;
+    bool pending;
+    bool stopping;
+    std::string path;
+    SnapshotData data;
+    SnapshotData spare;     // 写完的数据，等待Recycle取回
+};
+
+// 通过内存映射读取快照，各数组直接指向映射内存，不做解析
+class SnapshotReader {
+public:
+    // 映射并校验文件，格式或版本不符时返回false
+    bool Open(const char* path);
+
+    const SnapshotHeader& Header() const { return *header; }
+    const double* OrbitAngles() const;
+    const float* RotationAngles() const;
+
+    // N体状态的第component个分量（0-6依次为x, y, z, vx, vy, vz, mass）
+    const double* NBody(int component) const;
+
+private:
+    MappedFile file;
+    const SnapshotHeader* header = nullptr;
+};
+
+#endif // SNAPSHOT_H
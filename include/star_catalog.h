@@ -0,0 +1,56 @@
+#ifndef STAR_CATALOG_H
+#define STAR_CATALOG_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "mapped_file.h"
+
+// 星表的二进制格式
+// 文件头之后是按星等从亮到暗排序的定长记录，以本机字节序原样保存，读取时直接指向映射内存。
+// 格式变化时递增STAR_CATALOG_VERSION
+const uint32_t STAR_CATALOG_VERSION = 1;
+const size_t STAR_CATALOG_ALIGNMENT = 64;
+
+// 一颗恒星，也是GPU上的顶点格式
+struct StarRecord {
+    float x, y, z;      // 场景坐标中的单位方向（黄道坐标，Y轴朝上）
+    float magnitude;    // 视星等
+    float colorIndex;   // B-V色指数
+};
+
+struct StarCatalogHeader {
+    char magic[8];          // "SOLARSTR"
+    uint32_t version;       // STAR_CATALOG_VERSION
+    uint32_t byteOrder;     // 0x01020304，用于识别字节序不同的机器写出的文件
+    uint64_t fileSize;      // 整个文件的字节数
+    uint64_t count;         // 恒星数
+    uint64_t starsOffset;   // 记录段的起始位置
+    uint32_t recordSize;    // sizeof(StarRecord)
+    uint32_t reserved;
+};
+
+// 把恒星按星等排序后写成星表文件，失败时返回false
+bool WriteStarCatalog(const char* path, std::vector<StarRecord> stars);
+
+// 通过内存映射读取星表，不做解析；记录一直指向映射内存，直到Close或对象销毁
+class StarCatalog {
+public:
+    // 映射并校验文件，格式或版本不符时返回false
+    bool Open(const char* path);
+
+    void Close();
+
+    bool IsOpen() const { return header != nullptr; }
+    size_t Size() const { return header != nullptr ? static_cast<size_t>(header->count) : 0; }
+    const StarRecord* Stars() const;
+
+    // 星等不超过limit的恒星数；记录按星等排序，这些恒星正好是前若干个（二分查找，只访问少量页面）
+    size_t CountBrighterThan(float limit) const;
+
+private:
+    MappedFile file;
+    const StarCatalogHeader* header = nullptr;
+};
+
+#endif // STAR_CATALOG_H
@@ -0,0 +1,40 @@
+#ifndef STAR_RENDERER_H
+#define STAR_RENDERER_H
+
+#include <cstddef>
+#include <GL/glew.h>
+#include "star_catalog.h"
+
+// 星空背景渲染器
+// 星表记录一次性上传到静态VBO，之后每帧只设置uniform并绘制。恒星位于无穷远，只随相机旋转，
+// 按星等决定点的大小和亮度，按色指数决定颜色。记录按星等排序，只绘制不超过极限星等的前缀，
+// 顶点着色器中同样丢弃暗于极限星等的恒星
+class StarRenderer {
+public:
+    StarRenderer();
+    ~StarRenderer();
+
+    // 把星表整体上传到显存（直接从映射内存拷贝，不做解析）
+    void Upload(const StarCatalog& catalog);
+
+    size_t Size() const { return count; }
+
+    // 绘制前visible颗恒星，magnitudeLimit为极限星等（视图和投影矩阵来自FrameData uniform块）
+    // 应在清屏后最先绘制，不写入深度
+    void Draw(size_t visible, float magnitudeLimit);
+
+private:
+    // 着色器程序
+    GLuint shader;
+
+    // 链接时查询好的uniform位置
+    GLint magnitudeLimitLocation;
+
+    // 已上传的恒星数
+    size_t count;
+
+    // VAO和VBO
+    GLuint VAO, VBO;
+};
+
+#endif // STAR_RENDERER_H
@@ -3,6 +3,8 @@
 
 #include <map>
 #include <string>
+#include <utility>
+#include <vector>
 #include <glm/glm.hpp>
 #include <GL/glew.h>
 #include <ft2build.h>
@@ -10,35 +12,96 @@
 
 // 存储字符的结构体
 struct Character {
-    GLuint TextureID;   // 字符纹理ID
+    glm::vec2 UVMin;    // 字形在图集中的左上角纹理坐标
+    glm::vec2 UVMax;    // 字形在图集中的右下角纹理坐标
     glm::ivec2 Size;    // 字符大小
     glm::ivec2 Bearing; // 从基线到字符左侧/顶部的偏移量
     GLuint Advance;     // 到下一个字符的水平偏移量
 };
 
+// 文字顶点：屏幕坐标、图集纹理坐标和颜色
+struct TextVertex {
+    float x, y;
+    float u, v;
+    float r, g, b;
+};
+
+// 已光栅化的字体：一张图集纹理和对应的ASCII字符表
+struct Font {
+    GLuint Atlas;                 // 字形图集纹理
+    Character Characters[128];    // ASCII字符表
+};
+
 class TextRenderer {
 public:
-    TextRenderer(unsigned int width, unsigned int height);
+    TextRenderer();
     ~TextRenderer();
     
-    // 加载字体
+    // 加载并切换到指定字体，所有字形打包到一张图集纹理中
+    // 每种(字体文件, 字号)只光栅化一次，之后常驻缓存，再次切换只是换一个指针
     bool Load(std::string font, unsigned int fontSize);
     
-    // 渲染文本
-    void RenderText(std::string text, float x, float y, float scale, glm::vec3 color = glm::vec3(1.0f));
+    // 渲染文本：只把字形四边形追加到本帧的顶点流中
+    void RenderText(const std::string& text, float x, float y, float scale, glm::vec3 color = glm::vec3(1.0f));
+    
+    // 创建一个保留文本对象，返回句柄
+    // 保留文本的顶点常驻显存，只有内容、位置或字体变化时才重新排版上传
+    int CreateText();
+    
+    // 设置保留文本，与当前内容相同时什么也不做
+    void SetText(int handle, const std::string& text, float x, float y, float scale, glm::vec3 color = glm::vec3(1.0f));
+    
+    // 绘制所有保留文本和本帧追加的文本，每帧结束前调用；两者在同一个缓冲区中，一次绘制
+    void Flush();
     
 private:
+    // 保留文本对象
+    struct RetainedText {
+        std::string text;
+        float x, y, scale;
+        glm::vec3 color;
+    };
+    
+    // 把一行文字的字形四边形追加到顶点数组中
+    void Layout(std::vector<TextVertex>& out, const std::string& text, float x, float y, float scale, glm::vec3 color) const;
+    
+    // 切换字体前绘制本帧已追加的文本（它们是用旧字体排版的）
+    void DrawPending();
+    
+    // 上传顶点：缓冲区前部是保留文本（只在变化后上传），本帧追加的文本紧接在后，容量不足时重新分配
+    void Upload();
+    
+    // 用当前字体的图集绘制缓冲区中[first, first + count)的顶点
+    void Draw(size_t first, size_t count);
+    
+
     // 着色器程序
     GLuint shader;
     
-    // 投影矩阵
-    glm::mat4 projection;
+    // FreeType库，首次加载字体时初始化
+    FT_Library ft;
+    bool ftInitialized;
     
-    // 字符映射表
-    std::map<char, Character> Characters;
+    // 字体缓存，键为(字体文件, 字号)
+    std::map<std::pair<std::string, unsigned int>, Font> fonts;
     
-    // VAO和VBO
+    // 当前使用的字体
+    const Font* current;
+    
+    // 本帧待绘制的顶点
+    std::vector<TextVertex> vertices;
+    
+    // VBO当前容量（顶点数）
+    size_t capacity;
+    
+    // VAO和VBO，保留文本和本帧追加的文本共用
     GLuint VAO, VBO;
+    
+    // 保留文本及其排版结果
+    std::vector<RetainedText> retained;
+    std::vector<TextVertex> retainedVertices;
+    bool retainedDirty;
+    bool retainedUploaded;  // retainedVertices是否已在VBO前部
 };
 
-#endif // TEXT_RENDERER_H 
\ No newline at end of file
+#endif // TEXT_RENDERER_H
\ No newline at end of file
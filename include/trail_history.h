@@ -0,0 +1,67 @@
+#ifndef TRAIL_HISTORY_H
+#define TRAIL_HISTORY_H
+
+#include <vector>
+#include <glm/glm.hpp>
+#include "frustum.h"
+
+// 轨迹分段的长度，每段维护一个包围盒用于视锥体裁剪
+const unsigned int TRAIL_SEGMENT_POINTS = 32;
+
+// 固定容量的环形轨迹历史
+// 写满后新点覆盖最旧的点，追加操作为O(1)，与容量无关。
+// 轨迹点以double的世界坐标传入，相对于清空后第一个点（原点）以float保存，
+// 远离场景原点时精度只取决于轨迹本身的跨度
+class TrailHistory {
+public:
+    // 一段连续存储的轨迹点
+    struct Span {
+        const glm::vec3* data;
+        unsigned int count;
+    };
+
+    explicit TrailHistory(unsigned int capacity = 0);
+
+    // 追加一个世界坐标的轨迹点
+    void Push(const glm::dvec3& point);
+
+    // 清空轨迹
+    void Clear();
+
+    unsigned int Size() const { return count; }
+    unsigned int Capacity() const { return static_cast<unsigned int>(points.size()); }
+    bool Empty() const { return count == 0; }
+
+    // 轨迹点的原点（世界坐标）
+    const glm::dvec3& Origin() const { return origin; }
+
+    // 按时间顺序访问相对于原点的轨迹点，0为最旧的点；没有轨迹点时返回(0, 0, 0)
+    const glm::vec3& operator[](unsigned int i) const;
+
+    // 最新的点（相对于原点），没有轨迹点时返回(0, 0, 0)
+    const glm::vec3& Newest() const;
+
+    // 按时间顺序拆成两段连续存储：first为最旧的一段，second紧随其后
+    // 两段可以直接作为两次缓冲区上传的源数据
+    void Spans(Span& first, Span& second) const;
+
+    // 是否有任何轨迹分段的包围盒与视锥体相交，offset为原点在视锥体坐标系中的位置
+    bool Intersects(const Frustum& frustum, const glm::vec3& offset) const;
+
+private:
+    // 一个分段的包围盒
+    // bounds保守地覆盖该段所有有效点；fresh只覆盖本轮新写入的点，整段写完后替换bounds
+    struct Segment {
+        glm::vec3 boundsMin, boundsMax;
+        glm::vec3 freshMin, freshMax;
+        bool valid;
+    };
+
+    glm::dvec3 origin;             // 轨迹点的原点
+    std::vector<glm::vec3> points; // 环形存储，相对于原点
+    unsigned int head;             // 下一个写入位置
+    unsigned int count;            // 有效点数
+    std::vector<Segment> segments; // 分段包围盒
+};
+
+#endif // TRAIL_HISTORY_H
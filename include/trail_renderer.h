@@ -0,0 +1,66 @@
+#ifndef TRAIL_RENDERER_H
+#define TRAIL_RENDERER_H
+
+#include <vector>
+#include <glm/glm.hpp>
+#include <GL/glew.h>
+#include "trail_history.h"
+
+// 常驻显存的轨迹渲染器
+// 所有轨迹共享一个VBO，每条轨迹占用 2 * capacity 个顶点的镜像环形区域：
+// 新的轨迹点同时写入两半，因此最近的 capacity 个点总是连续的，一次绘制即可完成。
+// 顶点相对于各自轨迹的原点保存，绘制时加上原点相对于相机的偏移
+class TrailRenderer {
+public:
+    TrailRenderer(unsigned int capacity);
+    ~TrailRenderer();
+
+    // 注册一条新轨迹，返回轨迹编号
+    int AddTrail();
+
+    // 追加一个轨迹点（相对于轨迹原点），每次只上传这一个点
+    void Push(int trail, const glm::vec3& point);
+
+    // 用CPU端的轨迹历史整体重写一条轨迹
+    void Upload(int trail, const TrailHistory& history);
+
+    // 清空轨迹
+    void Clear(int trail);
+
+    // 设置轨迹本帧是否可见（视锥体裁剪结果）
+    void SetVisible(int trail, bool visible);
+
+    // 设置轨迹原点相对于相机的位置，每帧更新
+    void SetOffset(int trail, const glm::vec3& offset);
+
+    // 绘制所有轨迹（视图和投影矩阵来自FrameData uniform块）
+    void Draw();
+
+private:
+    // 单条轨迹在环形区域中的状态
+    struct Trail {
+        unsigned int head;  // 下一个写入位置
+        unsigned int count; // 有效点数
+        bool visible;       // 本帧是否可见
+        glm::vec3 offset;   // 原点相对于相机的位置
+    };
+
+    // 着色器程序
+    GLuint shader;
+
+    // 链接时查询好的uniform位置
+    GLint trailFirstLocation;
+    GLint trailCountLocation;
+    GLint trailOffsetLocation;
+
+    // 每条轨迹的最大点数
+    unsigned int capacity;
+
+    // 轨迹状态表
+    std::vector<Trail> trails;
+
+    // VAO和VBO
+    GLuint VAO, VBO;
+};
+
+#endif // TRAIL_RENDERER_H
@@ -0,0 +1,50 @@
+#ifndef WISDOM_HOLMAN_H
+#define WISDOM_HOLMAN_H
+
+#include <cstddef>
+#include <vector>
+
+// Wisdom-Holman混合变量辛积分器，民主日心坐标（Duncan, Levison & Lee 1998）
+// 哈密顿量拆成三部分：各行星绕中心天体的开普勒运动、行星之间的相互作用、中心天体的动量项。
+// 每步为 半步相互作用 -> 半步动量项 -> 开普勒漂移 -> 半步动量项 -> 半步相互作用，
+// 开普勒部分精确求解，步长可以取最短轨道周期的几十分之一，能量误差长期有界
+class WisdomHolman {
+public:
+    WisdomHolman(double gravity, double centralMass);
+
+    // 添加一个行星，位置和速度均相对于中心天体（日心）
+    size_t Add(double mass, double x, double y, double z, double vx, double vy, double vz);
+
+    size_t Size() const { return mass.size(); }
+
+    // 积分一步
+    void Step(double dt);
+
+    // 质心系中的总能量
+    double Energy();
+
+    // 日心位置
+    const double* X() const { return x.data(); }
+    const double* Y() const { return y.data(); }
+    const double* Z() const { return z.data(); }
+
+private:
+    // 把日心速度换成质心速度（添加天体后第一次积分前进行）
+    void Prepare();
+
+    // 行星之间的相互作用，改变速度
+    void InteractionKick(double dt);
+
+    // 中心天体动量项，改变位置
+    void Jump(double dt);
+
+    double gravity;
+    double centralMass;
+    bool prepared;                  // 速度是否已经是质心速度
+
+    std::vector<double> x, y, z;    // 日心位置
+    std::vector<double> vx, vy, vz; // 质心速度
+    std::vector<double> mass;
+};
+
+#endif // WISDOM_HOLMAN_H
@@ -4,34 +4,41 @@ out vec4 FragColor;
 in vec2 TexCoord;
 in vec3 FragPos;
 in vec3 Normal;
+flat in float TextureLayer;
+flat in float Emissive;
 
-uniform sampler2D texture1;
-uniform vec3 lightPos;
-uniform vec3 viewPos;
-uniform vec3 lightColor;
-uniform float ambientStrength;
-uniform bool isSun;
+uniform sampler2DArray texture1;
+
+// 每帧共享数据（与FrameData结构体一致）
+layout (std140) uniform FrameData {
+    mat4 view;
+    mat4 projection;
+    mat4 screen;
+    vec4 lightPos;    // xyz: 光源位置
+    vec4 lightColor;  // xyz: 光源颜色, w: 环境光强度
+    vec4 viewPos;     // xyz: 相机位置
+};
 
 void main()
 {
     // 直接从纹理中获取颜色
-    vec4 texColor = texture(texture1, TexCoord);
+    vec4 texColor = texture(texture1, vec3(TexCoord, TextureLayer));
     
     // 如果是太阳，直接使用纹理颜色并增强亮度
-    if(isSun) {
+    if(Emissive > 0.5) {
         // 使太阳发光，增强亮度
         vec3 sunColor = texColor.rgb * 1.5;
         FragColor = vec4(sunColor, texColor.a);
     }
     else {
         // 环境光
-        vec3 ambient = ambientStrength * lightColor;
+        vec3 ambient = lightColor.w * lightColor.rgb;
         
         // 漫反射
         vec3 norm = normalize(Normal);
-        vec3 lightDir = normalize(lightPos - FragPos);
+        vec3 lightDir = normalize(lightPos.xyz - FragPos);
         float diff = max(dot(norm, lightDir), 0.0);
-        vec3 diffuse = diff * lightColor;
+        vec3 diffuse = diff * lightColor.rgb;
         
         // 最终颜色
         vec3 result = (ambient + diffuse) * texColor.rgb;
@@ -0,0 +1,14 @@
+#version 330 core
+out vec4 FragColor;
+
+uniform vec3 pointColor;
+
+void main()
+{
+    // 把方形的点裁成圆形
+    vec2 offset = gl_PointCoord - vec2(0.5);
+    if (dot(offset, offset) > 0.25) {
+        discard;
+    }
+    FragColor = vec4(pointColor, 1.0);
+}
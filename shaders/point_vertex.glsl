@@ -0,0 +1,19 @@
+#version 330 core
+layout (location = 0) in vec3 aPos;
+
+// 每帧共享数据（与FrameData结构体一致）
+layout (std140) uniform FrameData {
+    mat4 view;
+    mat4 projection;
+    mat4 screen;
+    vec4 lightPos;    // xyz: 光源位置
+    vec4 lightColor;  // xyz: 光源颜色, w: 环境光强度
+    vec4 viewPos;     // xyz: 相机位置
+};
+uniform float pointSize;  // 点的像素大小
+
+void main()
+{
+    gl_Position = projection * view * vec4(aPos, 1.0);
+    gl_PointSize = pointSize;
+}
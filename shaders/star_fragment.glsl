@@ -0,0 +1,11 @@
+#version 330 core
+in vec4 StarColor;
+out vec4 FragColor;
+
+void main()
+{
+    // 圆形的点，边缘柔和过渡
+    vec2 offset = gl_PointCoord - vec2(0.5);
+    float edge = 1.0 - smoothstep(0.3, 0.5, length(offset));
+    FragColor = vec4(StarColor.rgb, StarColor.a * edge);
+}
@@ -0,0 +1,53 @@
+#version 330 core
+layout (location = 0) in vec3 aDirection;
+layout (location = 1) in float aMagnitude;
+layout (location = 2) in float aColorIndex;
+
+out vec4 StarColor;
+
+// 每帧共享数据（与FrameData结构体一致）
+layout (std140) uniform FrameData {
+    mat4 view;
+    mat4 projection;
+    mat4 screen;
+    vec4 lightPos;    // xyz: 光源位置
+    vec4 lightColor;  // xyz: 光源颜色, w: 环境光强度
+    vec4 viewPos;     // xyz: 相机位置
+};
+uniform float magnitudeLimit;  // 极限星等，更暗的恒星不绘制
+
+// 由B-V色指数近似恒星颜色：蓝白 -> 白 -> 黄 -> 橙红
+vec3 starColor(float bv)
+{
+    vec3 blue = vec3(0.62, 0.72, 1.0);
+    vec3 white = vec3(1.0, 1.0, 1.0);
+    vec3 yellow = vec3(1.0, 0.9, 0.7);
+    vec3 red = vec3(1.0, 0.6, 0.4);
+    if (bv < 0.3) {
+        return mix(blue, white, clamp((bv + 0.4) / 0.7, 0.0, 1.0));
+    }
+    if (bv < 0.9) {
+        return mix(white, yellow, (bv - 0.3) / 0.6);
+    }
+    return mix(yellow, red, clamp((bv - 0.9) / 1.1, 0.0, 1.0));
+}
+
+void main()
+{
+    // 暗于极限星等的恒星放到裁剪空间之外，点的大小为0
+    if (aMagnitude > magnitudeLimit) {
+        gl_Position = vec4(2.0, 2.0, 2.0, 1.0);
+        gl_PointSize = 0.0;
+        StarColor = vec4(0.0);
+        return;
+    }
+
+    // 方向向量只做旋转（w = 0），深度固定在远平面
+    vec4 clip = projection * vec4(mat3(view) * aDirection, 0.0);
+    gl_Position = clip.xyww;
+
+    // 相对于极限星等的亮度：每暗5等亮度降为1/100；点的面积和亮度都随亮度增长，直到上限
+    float flux = pow(10.0, -0.4 * (aMagnitude - magnitudeLimit));
+    gl_PointSize = clamp(0.15 * sqrt(flux), 1.0, 6.0);
+    StarColor = vec4(starColor(aColorIndex), clamp(0.1 * flux, 0.1, 1.0));
+}
@@ -1,12 +1,23 @@
 #version 330 core
 layout (location = 0) in vec4 vertex; // <vec2 pos, vec2 tex>
+layout (location = 1) in vec3 aColor;
 
 out vec2 TexCoords;
+out vec3 TextColor;
 
-uniform mat4 projection;
+// 每帧共享数据（与FrameData结构体一致）
+layout (std140) uniform FrameData {
+    mat4 view;
+    mat4 projection;
+    mat4 screen;
+    vec4 lightPos;    // xyz: 光源位置
+    vec4 lightColor;  // xyz: 光源颜色, w: 环境光强度
+    vec4 viewPos;     // xyz: 相机位置
+};
 
 void main()
 {
-    gl_Position = projection * vec4(vertex.xy, 0.0, 1.0);
+    gl_Position = screen * vec4(vertex.xy, 0.0, 1.0);
     TexCoords = vertex.zw;
+    TextColor = aColor;
 } 
\ No newline at end of file
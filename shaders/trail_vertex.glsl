@@ -1,14 +1,33 @@
 #version 330 core
 layout (location = 0) in vec3 aPos;
-layout (location = 1) in vec4 aColor;
 
 out vec4 Color;
 
-uniform mat4 view;
-uniform mat4 projection;
+// 每帧共享数据（与FrameData结构体一致）
+layout (std140) uniform FrameData {
+    mat4 view;
+    mat4 projection;
+    mat4 screen;
+    vec4 lightPos;    // xyz: 光源位置
+    vec4 lightColor;  // xyz: 光源颜色, w: 环境光强度
+    vec4 viewPos;     // xyz: 相机位置
+};
+uniform int trailFirst;  // 本条轨迹第一个顶点的编号
+uniform int trailCount;  // 本条轨迹的顶点数
+uniform vec3 trailOffset; // 轨迹原点相对于相机的位置
 
 void main()
 {
-    gl_Position = projection * view * vec4(aPos, 1.0);
-    Color = aColor;
-} 
\ No newline at end of file
+    gl_Position = projection * view * vec4(aPos + trailOffset, 1.0);
+
+    // 计算透明度，越新的点越不透明
+    int i = gl_VertexID - trailFirst;
+    float alpha = float(i) / float(trailCount);
+
+    // 如果是相对于当前点180度之外的轨迹点，透明度设为0
+    if (i < trailCount / 2) {
+        alpha = 0.0;
+    }
+
+    Color = vec4(1.0, 1.0, 1.0, alpha);
+}
\ No newline at end of file
@@ -3,18 +3,33 @@ layout (location = 0) in vec3 aPos;
 layout (location = 1) in vec3 aNormal;
 layout (location = 2) in vec2 aTexCoord;
 
+// 实例属性
+layout (location = 3) in mat4 aModel;     // 模型矩阵（占用位置3-6）
+layout (location = 7) in vec2 aMaterial;  // x: 纹理层号, y: 自发光标志
+layout (location = 8) in mat3 aNormalMatrix; // 在CPU上算好的法线矩阵（占用位置8-10）
+
 out vec2 TexCoord;
 out vec3 FragPos;
 out vec3 Normal;
+flat out float TextureLayer;
+flat out float Emissive;
 
-uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+// 每帧共享数据（与FrameData结构体一致）
+layout (std140) uniform FrameData {
+    mat4 view;
+    mat4 projection;
+    mat4 screen;
+    vec4 lightPos;    // xyz: 光源位置
+    vec4 lightColor;  // xyz: 光源颜色, w: 环境光强度
+    vec4 viewPos;     // xyz: 相机位置
+};
 
 void main()
 {
-    gl_Position = projection * view * model * vec4(aPos, 1.0);
-    FragPos = vec3(model * vec4(aPos, 1.0));
-    Normal = mat3(transpose(inverse(model))) * aNormal;
+    gl_Position = projection * view * aModel * vec4(aPos, 1.0);
+    FragPos = vec3(aModel * vec4(aPos, 1.0));
+    Normal = aNormalMatrix * aNormal;
     TexCoord = aTexCoord;
-} 
\ No newline at end of file
+    TextureLayer = aMaterial.x;
+    Emissive = aMaterial.y;
+}
\ No newline at end of file
@@ -0,0 +1,96 @@
+#include "../include/asteroid_belt.h"
+#include "../include/parallel_for.h"
+#include <cmath>
+#include <random>
+
+namespace {
+
+// 并行求解时每块的小天体数，是8通道的整数倍
+const size_t EVALUATE_GRAIN = 8 * 1024;
+
+const double TWO_PI = 6.283185307179586;
+const double INV_TWO_PI = 0.15915494309189535;
+const double ROUND_MAGIC = 6755399441055744.0;
+
+// 由时间求平近点角，在double中归约到[-π, π]后再转成float，时间很大时也不损失精度
+// 取整用加减1.5 * 2^52的办法，std::floor在默认的浮点异常语义下不能向量化
+void meanAnomalies(const double* __restrict motion, const double* __restrict epoch, float* __restrict out,
+                   double time, size_t begin, size_t end)
+{
+    for (size_t i = begin; i < end; ++i) {
+        double phase = epoch[i] + motion[i] * time;
+        double turns = (phase * INV_TWO_PI + ROUND_MAGIC) - ROUND_MAGIC;
+        out[i] = static_cast<float>(phase - TWO_PI * turns);
+    }
+}
+
+// 把求解结果加上原点，按顶点格式交错写出
+void interleave(const float* __restrict x, const float* __restrict y, const float* __restrict z, float* __restrict out,
+                float originX, float originY, float originZ, size_t begin, size_t end)
+{
+    for (size_t i = begin; i < end; ++i) {
+        out[3 * i + 0] = x[i] + originX;
+        out[3 * i + 1] = y[i] + originY;
+        out[3 * i + 2] = z[i] + originZ;
+    }
+}
+
+}
+
+AsteroidBelt::AsteroidBelt(double gravity)
+    : gravity(gravity)
+{
+}
+
+void AsteroidBelt::AddRing(size_t count, float innerRadius, float outerRadius,
+                           float maxEccentricity, float maxInclination, unsigned int seed)
+{
+    std::mt19937 random(seed);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+
+    const size_t total = Size() + count;
+    meanMotion.reserve(total);
+    epochAnomaly.reserve(total);
+    meanAnomaly.resize(total);
+
+    for (size_t i = 0; i < count; i++) {
+        OrbitalElements elements;
+        elements.semiMajorAxis = innerRadius + (outerRadius - innerRadius) * unit(random);
+        elements.eccentricity = maxEccentricity * unit(random);
+        elements.inclination = maxInclination * unit(random);
+        elements.ascendingNode = static_cast<float>(TWO_PI) * unit(random);
+        elements.argumentOfPeriapsis = static_cast<float>(TWO_PI) * unit(random);
+        elements.meanAnomalyAtEpoch = static_cast<float>(TWO_PI) * unit(random);
+        orbits.Add(elements);
+
+        const double a = elements.semiMajorAxis;
+        meanMotion.push_back(std::sqrt(gravity / (a * a * a)));
+        epochAnomaly.push_back(elements.meanAnomalyAtEpoch);
+    }
+}
+
+void AsteroidBelt::Clear()
+{
+    orbits.Clear();
+    meanMotion.clear();
+    epochAnomaly.clear();
+    meanAnomaly.clear();
+}
+
+void AsteroidBelt::Evaluate(double time, float originX, float originY, float originZ, float* out, ThreadPool* pool)
+{
+    if (pool == nullptr) {
+        EvaluateRange(time, originX, originY, originZ, out, 0, Size());
+        return;
+    }
+    pool->ParallelFor(0, Size(), EVALUATE_GRAIN, [&](size_t begin, size_t end) {
+        EvaluateRange(time, originX, originY, originZ, out, begin, end);
+    });
+}
+
+void AsteroidBelt::EvaluateRange(double time, float originX, float originY, float originZ, float* out, size_t begin, size_t end)
+{
+    meanAnomalies(meanMotion.data(), epochAnomaly.data(), meanAnomaly.data(), time, begin, end);
+    orbits.Solve(meanAnomaly.data(), begin, end);
+    interleave(orbits.X(), orbits.Y(), orbits.Z(), out, originX, originY, originZ, begin, end);
+}
@@ -0,0 +1,414 @@
+#include "../include/barnes_hut.h"
+#include "../include/parallel_for.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// 并行处理时每块的天体数
+const size_t BUILD_GRAIN = 16 * 1024;
+const size_t WALK_GRAIN = 16;  // 组数
+
+// 求值时同时处理的天体数
+const unsigned int LANES = 8;
+
+// Morton码每轴的位数，以及对应的最大层数
+const int MORTON_BITS = 21;
+
+// 把21位整数的各位分开，每两位之间插入两个0
+uint64_t spreadBits(uint64_t v)
+{
+    v &= 0x1fffff;
+    v = (v | v << 32) & 0x1f00000000ffffULL;
+    v = (v | v << 16) & 0x1f0000ff0000ffULL;
+    v = (v | v << 8) & 0x100f00f00f00f00fULL;
+    v = (v | v << 4) & 0x10c30c30c30c30c3ULL;
+    v = (v | v << 2) & 0x1249249249249249ULL;
+    return v;
+}
+
+// 在调用线程或线程池上按固定块执行
+void forChunks(ThreadPool* pool, size_t count, size_t grain, const std::function<void(size_t, size_t)>& fn)
+{
+    if (pool == nullptr) {
+        for (size_t begin = 0; begin < count; begin += grain) {
+            fn(begin, std::min(begin + grain, count));
+        }
+    } else {
+        pool->ParallelFor(0, count, grain, fn);
+    }
+}
+
+} // namespace
+
+void BarnesHutTree::Build(const double* x, const double* y, const double* z, const double* mass, size_t count, ThreadPool* pool)
+{
+    nodes.clear();
+    keys.resize(count);
+    if (count == 0) {
+        return;
+    }
+
+    // 包围盒：各块分别统计，再按块的顺序合并
+    const size_t chunks = (count + BUILD_GRAIN - 1) / BUILD_GRAIN;
+    std::vector<double> chunkBounds(chunks * 6);
+    forChunks(pool, count, BUILD_GRAIN, [&](size_t begin, size_t end) {
+        double* b = &chunkBounds[begin / BUILD_GRAIN * 6];
+        b[0] = b[3] = x[begin];
+        b[1] = b[4] = y[begin];
+        b[2] = b[5] = z[begin];
+        for (size_t i = begin + 1; i < end; ++i) {
+            b[0] = std::min(b[0], x[i]); b[3] = std::max(b[3], x[i]);
+            b[1] = std::min(b[1], y[i]); b[4] = std::max(b[4], y[i]);
+            b[2] = std::min(b[2], z[i]); b[5] = std::max(b[5], z[i]);
+        }
+    });
+    double lower[3] = { chunkBounds[0], chunkBounds[1], chunkBounds[2] };
+    double upper[3] = { chunkBounds[3], chunkBounds[4], chunkBounds[5] };
+    for (size_t c = 1; c < chunks; ++c) {
+        for (int axis = 0; axis < 3; ++axis) {
+            lower[axis] = std::min(lower[axis], chunkBounds[c * 6 + axis]);
+            upper[axis] = std::max(upper[axis], chunkBounds[c * 6 + 3 + axis]);
+        }
+    }
+    double size = std::max(upper[0] - lower[0], std::max(upper[1] - lower[1], upper[2] - lower[2]));
+    if (!(size > 0.0)) {
+        size = 1.0;
+    }
+
+    // Morton码
+    const double scale = ((1 << MORTON_BITS) - 1) / size;
+    forChunks(pool, count, BUILD_GRAIN, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            uint64_t qx = static_cast<uint64_t>((x[i] - lower[0]) * scale);
+            uint64_t qy = static_cast<uint64_t>((y[i] - lower[1]) * scale);
+            uint64_t qz = static_cast<uint64_t>((z[i] - lower[2]) * scale);
+            keys[i] = { spreadBits(qx) << 2 | spreadBits(qy) << 1 | spreadBits(qz), static_cast<uint32_t>(i) };
+        }
+    });
+
+    // 排序：各块并行排序后两两归并。键包含原始编号，顺序唯一，与线程数无关
+    forChunks(pool, count, BUILD_GRAIN, [&](size_t begin, size_t end) {
+        std::sort(keys.begin() + begin, keys.begin() + end);
+    });
+    scratch.resize(count);
+    for (size_t width = BUILD_GRAIN; width < count; width *= 2) {
+        const size_t pairs = (count + 2 * width - 1) / (2 * width);
+        forChunks(pool, pairs, 1, [&](size_t begin, size_t end) {
+            for (size_t p = begin; p < end; ++p) {
+                size_t lo = p * 2 * width;
+                size_t mid = std::min(lo + width, count);
+                size_t hi = std::min(lo + 2 * width, count);
+                std::merge(keys.begin() + lo, keys.begin() + mid, keys.begin() + mid, keys.begin() + hi, scratch.begin() + lo);
+            }
+        });
+        keys.swap(scratch);
+    }
+
+    // 按排序后的顺序重排位置和质量
+    sx.resize(count);
+    sy.resize(count);
+    sz.resize(count);
+    sm.resize(count);
+    forChunks(pool, count, BUILD_GRAIN, [&](size_t begin, size_t end) {
+        for (size_t k = begin; k < end; ++k) {
+            uint32_t i = keys[k].second;
+            sx[k] = x[i];
+            sy[k] = y[i];
+            sz[k] = z[i];
+            sm[k] = mass[i];
+        }
+    });
+
+    // 自顶向下连接节点，每个节点只做8次二分查找，总开销O(N)
+    // 根单元取量化网格的全部2^MORTON_BITS格，保证每个天体都落在它的Morton码对应的单元内
+    groups.clear();
+    nodes.reserve(count / 2 + 1);
+    nodes.push_back(Node());
+    BuildNode(0, 0, static_cast<unsigned int>(count), 0, lower, (1 << MORTON_BITS) / scale, false);
+}
+
+void BarnesHutTree::BuildNode(int index, unsigned int first, unsigned int count, int level, const double* corner, double size, bool inGroup)
+{
+    if (!inGroup && count <= GROUP_SIZE) {
+        groups.push_back(index);
+        inGroup = true;
+    }
+
+    nodes[index].first = first;
+    nodes[index].count = count;
+    for (int axis = 0; axis < 3; ++axis) {
+        nodes[index].corner[axis] = corner[axis];
+    }
+    nodes[index].size = size;
+    nodes[index].size2 = size * size;
+    nodes[index].firstChild = -1;
+    nodes[index].childCount = 0;
+
+    if (count <= LEAF_SIZE || level == MORTON_BITS) {
+        // 叶节点：直接累加质心
+        double m = 0.0, cx = 0.0, cy = 0.0, cz = 0.0;
+        for (unsigned int k = first; k < first + count; ++k) {
+            m += sm[k];
+            cx += sm[k] * sx[k];
+            cy += sm[k] * sy[k];
+            cz += sm[k] * sz[k];
+        }
+        const double inv = m > 0.0 ? 1.0 / m : 0.0;
+        Node& leaf = nodes[index];
+        leaf.mass = m;
+        leaf.x = cx * inv;
+        leaf.y = cy * inv;
+        leaf.z = cz * inv;
+        std::fill(leaf.quadrupole, leaf.quadrupole + 6, 0.0);
+        for (unsigned int k = first; k < first + count; ++k) {
+            AddQuadrupole(leaf.quadrupole, sm[k], sx[k] - leaf.x, sy[k] - leaf.y, sz[k] - leaf.z);
+        }
+        return;
+    }
+
+    // 区间内的码在更高位上相同，按本层的3位切成最多8段
+    const int shift = 3 * (MORTON_BITS - 1 - level);
+    unsigned int bounds[9];
+    bounds[0] = first;
+    auto begin = keys.begin() + first, end = keys.begin() + first + count;
+    for (unsigned int octant = 1; octant < 8; ++octant) {
+        auto split = std::partition_point(begin, end, [&](const std::pair<uint64_t, uint32_t>& key) {
+            return ((key.first >> shift) & 7) < octant;
+        });
+        bounds[octant] = static_cast<unsigned int>(split - keys.begin());
+    }
+    bounds[8] = first + count;
+
+    int children = 0;
+    for (int octant = 0; octant < 8; ++octant) {
+        children += bounds[octant + 1] > bounds[octant] ? 1 : 0;
+    }
+
+    // 子节点连续分配，再逐个递归
+    const int firstChild = static_cast<int>(nodes.size());
+    nodes.resize(nodes.size() + children);
+    nodes[index].firstChild = firstChild;
+    nodes[index].childCount = children;
+
+    // 卦限的3位依次对应x、y、z的下一位
+    const double half = size * 0.5;
+    int child = firstChild;
+    for (int octant = 0; octant < 8; ++octant) {
+        if (bounds[octant + 1] > bounds[octant]) {
+            const double childCorner[3] = { corner[0] + ((octant >> 2) & 1) * half, corner[1] + ((octant >> 1) & 1) * half,
+                                            corner[2] + (octant & 1) * half };
+            BuildNode(child++, bounds[octant], bounds[octant + 1] - bounds[octant], level + 1, childCorner, half, inGroup);
+        }
+    }
+
+    // 由子节点合并质心
+    double m = 0.0, cx = 0.0, cy = 0.0, cz = 0.0;
+    for (int c = firstChild; c < firstChild + children; ++c) {
+        m += nodes[c].mass;
+        cx += nodes[c].mass * nodes[c].x;
+        cy += nodes[c].mass * nodes[c].y;
+        cz += nodes[c].mass * nodes[c].z;
+    }
+    const double inv = m > 0.0 ? 1.0 / m : 0.0;
+    Node& node = nodes[index];
+    node.mass = m;
+    node.x = cx * inv;
+    node.y = cy * inv;
+    node.z = cz * inv;
+
+    // 平行轴定理：子节点自身的四极矩加上其质心相对父质心的贡献
+    std::fill(node.quadrupole, node.quadrupole + 6, 0.0);
+    for (int c = firstChild; c < firstChild + children; ++c) {
+        const Node& childNode = nodes[c];
+        for (int q = 0; q < 6; ++q) {
+            node.quadrupole[q] += childNode.quadrupole[q];
+        }
+        AddQuadrupole(node.quadrupole, childNode.mass, childNode.x - node.x, childNode.y - node.y, childNode.z - node.z);
+    }
+}
+
+void BarnesHutTree::AddQuadrupole(double* q, double m, double dx, double dy, double dz)
+{
+    const double r2 = dx * dx + dy * dy + dz * dz;
+    q[0] += m * (3.0 * dx * dx - r2);
+    q[1] += m * (3.0 * dy * dy - r2);
+    q[2] += m * (3.0 * dz * dz - r2);
+    q[3] += m * 3.0 * dx * dy;
+    q[4] += m * 3.0 * dx * dz;
+    q[5] += m * 3.0 * dy * dz;
+}
+
+void BarnesHutTree::InteractionList::Clear()
+{
+    x.clear();
+    y.clear();
+    z.clear();
+    mass.clear();
+    for (std::vector<double>& component : q) {
+        component.clear();
+    }
+    nodes = 0;
+    leaves.clear();
+}
+
+void BarnesHutTree::InteractionList::Add(double px, double py, double pz, double m)
+{
+    x.push_back(px);
+    y.push_back(py);
+    z.push_back(pz);
+    mass.push_back(m);
+}
+
+unsigned long long BarnesHutTree::Accelerations(double theta, double gravity, double softening2,
+                                                double* ax, double* ay, double* az, ThreadPool* pool) const
+{
+    if (keys.empty()) {
+        return 0;
+    }
+
+    // 组按Morton顺序排列，相邻的组走过的节点相近
+    const size_t chunks = (groups.size() + WALK_GRAIN - 1) / WALK_GRAIN;
+    std::vector<unsigned long long> chunkInteractions(chunks, 0);
+    const double theta2 = theta * theta;
+    forChunks(pool, groups.size(), WALK_GRAIN, [&](size_t begin, size_t end) {
+        InteractionList list;
+        unsigned long long interactions = 0;
+        for (size_t g = begin; g < end; ++g) {
+            const Node& group = nodes[groups[g]];
+            Walk(group, theta2, list);
+
+            const size_t total = list.x.size();
+            const size_t nodeCount = list.nodes;
+            const double* __restrict lx = list.x.data();
+            const double* __restrict ly = list.y.data();
+            const double* __restrict lz = list.z.data();
+            const double* __restrict lm = list.mass.data();
+            const double* __restrict qxx = list.q[0].data();
+            const double* __restrict qyy = list.q[1].data();
+            const double* __restrict qzz = list.q[2].data();
+            const double* __restrict qxy = list.q[3].data();
+            const double* __restrict qxz = list.q[4].data();
+            const double* __restrict qyz = list.q[5].data();
+
+            // 组内天体按LANES个一批，内层循环遍历同一批天体，不需要重排浮点累加的顺序即可向量化
+            for (unsigned int block = group.first; block < group.first + group.count; block += LANES) {
+                const unsigned int valid = std::min<unsigned int>(LANES, group.first + group.count - block);
+                double px[LANES], py[LANES], pz[LANES];
+                double accX[LANES], accY[LANES], accZ[LANES];
+                for (unsigned int l = 0; l < LANES; ++l) {
+                    // 不足一批时重复最后一个天体，结果不写回
+                    const unsigned int k = block + std::min(l, valid - 1);
+                    px[l] = sx[k];
+                    py[l] = sy[k];
+                    pz[l] = sz[k];
+                    accX[l] = accY[l] = accZ[l] = 0.0;
+                }
+
+                // 节点：质心加四极矩，d为天体指向质心的向量
+                //   a = M d / r³ - Q d / r⁵ + 5/2 (dᵀQd) d / r⁷
+                for (size_t n = 0; n < nodeCount; ++n) {
+                    for (unsigned int l = 0; l < LANES; ++l) {
+                        double dx = lx[n] - px[l], dy = ly[n] - py[l], dz = lz[n] - pz[l];
+                        double inv = 1.0 / std::sqrt(dx * dx + dy * dy + dz * dz + softening2);
+                        double inv2 = inv * inv;
+                        double inv3 = inv * inv2;
+                        double inv5 = inv3 * inv2;
+                        double qdx = qxx[n] * dx + qxy[n] * dy + qxz[n] * dz;
+                        double qdy = qxy[n] * dx + qyy[n] * dy + qyz[n] * dz;
+                        double qdz = qxz[n] * dx + qyz[n] * dy + qzz[n] * dz;
+                        double dqd = dx * qdx + dy * qdy + dz * qdz;
+                        double s = lm[n] * inv3 + 2.5 * dqd * inv5 * inv2;
+                        accX[l] += dx * s - qdx * inv5;
+                        accY[l] += dy * s - qdy * inv5;
+                        accZ[l] += dz * s - qdz * inv5;
+                    }
+                }
+
+                // 单个天体：直接求和，自身的距离为0，贡献置零
+                for (size_t n = nodeCount; n < total; ++n) {
+                    for (unsigned int l = 0; l < LANES; ++l) {
+                        double dx = lx[n] - px[l], dy = ly[n] - py[l], dz = lz[n] - pz[l];
+                        double r2 = dx * dx + dy * dy + dz * dz;
+                        double inv = r2 > 0.0 ? 1.0 / std::sqrt(r2 + softening2) : 0.0;
+                        double s = lm[n] * inv * inv * inv;
+                        accX[l] += dx * s;
+                        accY[l] += dy * s;
+                        accZ[l] += dz * s;
+                    }
+                }
+
+                for (unsigned int l = 0; l < valid; ++l) {
+                    const uint32_t i = keys[block + l].second;
+                    ax[i] = gravity * accX[l];
+                    ay[i] = gravity * accY[l];
+                    az[i] = gravity * accZ[l];
+                }
+            }
+            interactions += static_cast<unsigned long long>(group.count) * total;
+        }
+        chunkInteractions[begin / WALK_GRAIN] = interactions;
+    });
+
+    unsigned long long total = 0;
+    for (unsigned long long interactions : chunkInteractions) {
+        total += interactions;
+    }
+    return total;
+}
+
+void BarnesHutTree::Walk(const Node& group, double theta2, InteractionList& list) const
+{
+    list.Clear();
+
+    // 组内天体的包围盒
+    double lower[3] = { sx[group.first], sy[group.first], sz[group.first] };
+    double upper[3] = { lower[0], lower[1], lower[2] };
+    for (unsigned int k = group.first + 1; k < group.first + group.count; ++k) {
+        lower[0] = std::min(lower[0], sx[k]); upper[0] = std::max(upper[0], sx[k]);
+        lower[1] = std::min(lower[1], sy[k]); upper[1] = std::max(upper[1], sy[k]);
+        lower[2] = std::min(lower[2], sz[k]); upper[2] = std::max(upper[2], sz[k]);
+    }
+
+    // 先收集节点，叶节点的天体暂存起来，最后接在节点后面
+    int stack[8 * (MORTON_BITS + 1)];
+    int top = 0;
+    stack[top++] = 0;
+    while (top > 0) {
+        const Node& node = nodes[stack[--top]];
+
+        // 单元与组包围盒相交时节点可能包含组内天体，质心也可能落在包围盒外，必须打开
+        bool overlaps = true;
+        for (int axis = 0; axis < 3; ++axis) {
+            overlaps = overlaps && node.corner[axis] <= upper[axis] && node.corner[axis] + node.size >= lower[axis];
+        }
+
+        // 质心到组包围盒的最近距离，对组内每个天体都不会高估
+        double d2 = 0.0;
+        const double center[3] = { node.x, node.y, node.z };
+        for (int axis = 0; axis < 3; ++axis) {
+            double outside = std::max(lower[axis] - center[axis], std::max(center[axis] - upper[axis], 0.0));
+            d2 += outside * outside;
+        }
+
+        if (!overlaps && node.size2 < theta2 * d2) {
+            list.Add(node.x, node.y, node.z, node.mass);
+            for (int q = 0; q < 6; ++q) {
+                list.q[q].push_back(node.quadrupole[q]);
+            }
+        } else if (node.firstChild < 0) {
+            list.leaves.push_back(static_cast<unsigned int>(&node - nodes.data()));
+        } else {
+            for (int c = node.firstChild; c < node.firstChild + node.childCount; ++c) {
+                stack[top++] = c;
+            }
+        }
+    }
+
+    list.nodes = list.x.size();
+    for (unsigned int leaf : list.leaves) {
+        for (unsigned int j = nodes[leaf].first; j < nodes[leaf].first + nodes[leaf].count; ++j) {
+            list.Add(sx[j], sy[j], sz[j], sm[j]);
+        }
+    }
+}
@@ -0,0 +1,37 @@
+#include "../include/checksum.h"
+
+namespace {
+
+const uint64_t FNV_OFFSET_BASIS = 14695981039346656037ull;
+const uint64_t FNV_PRIME = 1099511628211ull;
+
+} // namespace
+
+StateChecksum::StateChecksum()
+    : hash(FNV_OFFSET_BASIS)
+{
+}
+
+void StateChecksum::AddBytes(const void* data, size_t size)
+{
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= bytes[i];
+        hash *= FNV_PRIME;
+    }
+}
+
+void StateChecksum::Add(const double* values, size_t count)
+{
+    AddBytes(values, count * sizeof(double));
+}
+
+void StateChecksum::Add(const float* values, size_t count)
+{
+    AddBytes(values, count * sizeof(float));
+}
+
+void StateChecksum::Add(uint64_t value)
+{
+    AddBytes(&value, sizeof(value));
+}
@@ -0,0 +1,235 @@
+#include "../include/ephemeris.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+namespace {
+
+const char EPHEMERIS_MAGIC[8] = { 'S', 'O', 'L', 'A', 'R', 'E', 'P', 'H' };
+const uint32_t EPHEMERIS_BYTE_ORDER = 0x01020304;
+
+// 文件头和天体表都没有填充字节，布局与编译器无关
+static_assert(sizeof(EphemerisHeader) == 72, "EphemerisHeader layout changed, bump EPHEMERIS_VERSION");
+static_assert(sizeof(EphemerisBody) == 32, "EphemerisBody layout changed, bump EPHEMERIS_VERSION");
+
+size_t alignUp(size_t offset)
+{
+    return (offset + EPHEMERIS_ALIGNMENT - 1) / EPHEMERIS_ALIGNMENT * EPHEMERIS_ALIGNMENT;
+}
+
+// 用Clenshaw递推求切比雪夫级数 Σ c[k] T_k(x)，x在[-1, 1]内
+double chebyshev(const double* c, uint32_t count, double x)
+{
+    double b1 = 0.0, b2 = 0.0;
+    const double twoX = 2.0 * x;
+    for (uint32_t k = count; k-- > 1;) {
+        double b0 = c[k] + twoX * b1 - b2;
+        b2 = b1;
+        b1 = b0;
+    }
+    return c[0] + x * b1 - b2;
+}
+
+} // namespace
+
+uint32_t LayoutEphemerisBodies(std::vector<EphemerisBody>& bodies)
+{
+    uint32_t offset = 0;
+    for (EphemerisBody& body : bodies) {
+        body.offset = offset;
+        offset += 3 * body.coefficients * body.subintervals;
+    }
+    return offset;
+}
+
+bool WriteEphemeris(const char* path, double startDay, double segmentDays,
+                    const std::vector<EphemerisBody>& bodies, const std::vector<double>& segments)
+{
+    uint32_t segmentDoubles = 0;
+    for (const EphemerisBody& body : bodies) {
+        segmentDoubles = std::max(segmentDoubles, body.offset + 3 * body.coefficients * body.subintervals);
+    }
+    if (segmentDoubles == 0 || segments.size() % segmentDoubles != 0) {
+        return false;
+    }
+
+    EphemerisHeader header = {};
+    std::memcpy(header.magic, EPHEMERIS_MAGIC, sizeof(header.magic));
+    header.version = EPHEMERIS_VERSION;
+    header.byteOrder = EPHEMERIS_BYTE_ORDER;
+    header.startDay = startDay;
+    header.segmentDays = segmentDays;
+    header.segmentCount = segments.size() / segmentDoubles;
+    header.bodyCount = static_cast<uint32_t>(bodies.size());
+    header.segmentDoubles = segmentDoubles;
+    header.bodiesOffset = alignUp(sizeof(EphemerisHeader));
+    header.segmentsOffset = alignUp(header.bodiesOffset + bodies.size() * sizeof(EphemerisBody));
+    header.fileSize = header.segmentsOffset + segments.size() * sizeof(double);
+
+    // 先写临时文件再改名，不会留下写了一半的星历
+    const std::string temporary = std::string(path) + ".tmp";
+    FILE* file = std::fopen(temporary.c_str(), "wb");
+    if (file == nullptr) {
+        return false;
+    }
+    static const char zeros[EPHEMERIS_ALIGNMENT] = {};
+    const size_t headerPadding = header.bodiesOffset - sizeof(header);
+    const size_t bodiesPadding = header.segmentsOffset - header.bodiesOffset - bodies.size() * sizeof(EphemerisBody);
+    bool ok = std::fwrite(&header, sizeof(header), 1, file) == 1
+           && std::fwrite(zeros, 1, headerPadding, file) == headerPadding
+           && std::fwrite(bodies.data(), sizeof(EphemerisBody), bodies.size(), file) == bodies.size()
+           && std::fwrite(zeros, 1, bodiesPadding, file) == bodiesPadding
+           && std::fwrite(segments.data(), sizeof(double), segments.size(), file) == segments.size();
+    ok = (std::fclose(file) == 0) && ok;
+    if (!ok || std::rename(temporary.c_str(), path) != 0) {
+        std::remove(temporary.c_str());
+        return false;
+    }
+    return true;
+}
+
+Ephemeris::Ephemeris()
+    : header(nullptr), bodies(nullptr), lastSlot(0), clock(0), hits(0), misses(0)
+{
+}
+
+bool Ephemeris::Open(const char* path)
+{
+    Close();
+    // 星历文件可能很大而每次只用到几段，不预先载入
+    if (!file.Open(path, false) || file.Size() < sizeof(EphemerisHeader)) {
+        return false;
+    }
+
+    const EphemerisHeader* h = reinterpret_cast<const EphemerisHeader*>(file.Data());
+    if (std::memcmp(h->magic, EPHEMERIS_MAGIC, sizeof(h->magic)) != 0 || h->version != EPHEMERIS_VERSION
+        || h->byteOrder != EPHEMERIS_BYTE_ORDER || h->fileSize != file.Size()
+        || !(h->segmentDays > 0.0) || h->segmentCount == 0) {
+        return false;
+    }
+
+    // 天体表和段记录必须对齐并且完整地落在文件内，每个天体的系数块不能超出段记录
+    if (h->bodiesOffset % EPHEMERIS_ALIGNMENT != 0 || h->segmentsOffset % EPHEMERIS_ALIGNMENT != 0
+        || h->bodyCount > file.Size() || h->segmentCount > file.Size()
+        || h->bodiesOffset + h->bodyCount * sizeof(EphemerisBody) > h->segmentsOffset
+        || h->segmentsOffset + h->segmentCount * h->segmentDoubles * sizeof(double) > file.Size()) {
+        return false;
+    }
+    const EphemerisBody* b = reinterpret_cast<const EphemerisBody*>(file.Data() + h->bodiesOffset);
+    for (uint32_t i = 0; i < h->bodyCount; i++) {
+        uint64_t end = b[i].offset + 3ull * b[i].coefficients * b[i].subintervals;
+        if (b[i].coefficients == 0 || b[i].subintervals == 0 || end > h->segmentDoubles
+            || std::memchr(b[i].name, '\0', EPHEMERIS_NAME_LENGTH) == nullptr) {
+            return false;
+        }
+    }
+
+    header = h;
+    bodies = b;
+    cache.assign(CACHE_SEGMENTS, CacheSlot{ 0, 0, false, {} });
+    for (CacheSlot& slot : cache) {
+        slot.coefficients.resize(h->segmentDoubles);
+    }
+    return true;
+}
+
+void Ephemeris::Close()
+{
+    header = nullptr;
+    bodies = nullptr;
+    cache.clear();
+    lastSlot = 0;
+    clock = hits = misses = 0;
+    file.Close();
+}
+
+int Ephemeris::FindBody(const char* name) const
+{
+    for (size_t i = 0; i < BodyCount(); i++) {
+        if (std::strcmp(bodies[i].name, name) == 0) {
+            return static_cast<int>(i);
+        }
+    }
+    return -1;
+}
+
+double Ephemeris::StartDay() const
+{
+    return header != nullptr ? header->startDay : 0.0;
+}
+
+double Ephemeris::EndDay() const
+{
+    return header != nullptr ? header->startDay + header->segmentDays * header->segmentCount : 0.0;
+}
+
+const double* Ephemeris::Segment(uint64_t segment)
+{
+    // 逐帧查询时几乎总是命中上一次的位置
+    CacheSlot* slot = &cache[lastSlot];
+    if (slot->valid && slot->segment == segment) {
+        slot->lastUsed = ++clock;
+        hits++;
+        return slot->coefficients.data();
+    }
+
+    // 缓存只有几十项，线性查找比散列更快；同时记下最久未用的一项
+    size_t victim = 0;
+    for (size_t i = 0; i < cache.size(); i++) {
+        if (cache[i].valid && cache[i].segment == segment) {
+            cache[i].lastUsed = ++clock;
+            lastSlot = i;
+            hits++;
+            return cache[i].coefficients.data();
+        }
+        if (!cache[i].valid || (cache[victim].valid && cache[i].lastUsed < cache[victim].lastUsed)) {
+            victim = i;
+        }
+    }
+
+    // 未命中：从映射内存拷贝整段记录
+    const double* source = reinterpret_cast<const double*>(file.Data() + header->segmentsOffset) + segment * header->segmentDoubles;
+    slot = &cache[victim];
+    std::memcpy(slot->coefficients.data(), source, header->segmentDoubles * sizeof(double));
+    slot->segment = segment;
+    slot->valid = true;
+    slot->lastUsed = ++clock;
+    lastSlot = victim;
+    misses++;
+    return slot->coefficients.data();
+}
+
+bool Ephemeris::Position(size_t body, double day, double position[3])
+{
+    if (header == nullptr || body >= header->bodyCount) {
+        return false;
+    }
+    const double t = (day - header->startDay) / header->segmentDays;
+    if (!(t >= 0.0) || t > static_cast<double>(header->segmentCount)) {
+        return false;
+    }
+
+    // 所在的段；正好落在最后一段的终点时仍用最后一段
+    uint64_t segment = static_cast<uint64_t>(t);
+    if (segment == header->segmentCount) {
+        segment--;
+    }
+    const EphemerisBody& b = bodies[body];
+    const double* coefficients = Segment(segment) + b.offset;
+
+    // 所在的子区间，以及子区间内归一化到[-1, 1]的时间
+    double local = (t - static_cast<double>(segment)) * b.subintervals;
+    uint32_t sub = static_cast<uint32_t>(local);
+    if (sub == b.subintervals) {
+        sub--;
+    }
+    const double x = 2.0 * (local - sub) - 1.0;
+
+    const double* c = coefficients + 3 * b.coefficients * sub;
+    for (int k = 0; k < 3; k++) {
+        position[k] = chebyshev(c + k * b.coefficients, b.coefficients, x);
+    }
+    return true;
+}
@@ -0,0 +1,55 @@
+#include "../include/frustum.h"
+
+Frustum::Frustum()
+{
+    // 默认不裁剪任何物体
+    for (int i = 0; i < 6; ++i) {
+        planes[i] = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+    }
+}
+
+Frustum::Frustum(const glm::mat4& m)
+{
+    // 矩阵的行向量（glm按列存储）
+    glm::vec4 row0(m[0][0], m[1][0], m[2][0], m[3][0]);
+    glm::vec4 row1(m[0][1], m[1][1], m[2][1], m[3][1]);
+    glm::vec4 row2(m[0][2], m[1][2], m[2][2], m[3][2]);
+    glm::vec4 row3(m[0][3], m[1][3], m[2][3], m[3][3]);
+
+    planes[0] = row3 + row0; // 左
+    planes[1] = row3 - row0; // 右
+    planes[2] = row3 + row1; // 下
+    planes[3] = row3 - row1; // 上
+    planes[4] = row3 + row2; // 近
+    planes[5] = row3 - row2; // 远
+
+    // 归一化，使平面方程的值等于有向距离
+    for (int i = 0; i < 6; ++i) {
+        planes[i] /= glm::length(glm::vec3(planes[i]));
+    }
+}
+
+bool Frustum::IntersectsSphere(const glm::vec3& center, float radius) const
+{
+    for (int i = 0; i < 6; ++i) {
+        if (glm::dot(glm::vec3(planes[i]), center) + planes[i].w < -radius) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool Frustum::IntersectsBox(const glm::vec3& boxMin, const glm::vec3& boxMax) const
+{
+    for (int i = 0; i < 6; ++i) {
+        // 取包围盒在平面法线方向上最靠前的顶点
+        glm::vec3 normal(planes[i]);
+        glm::vec3 positive(normal.x >= 0.0f ? boxMax.x : boxMin.x,
+                           normal.y >= 0.0f ? boxMax.y : boxMin.y,
+                           normal.z >= 0.0f ? boxMax.z : boxMin.z);
+        if (glm::dot(normal, positive) + planes[i].w < 0.0f) {
+            return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,264 @@
+#include "../include/kepler.h"
+#include "../include/parallel_for.h"
+#include <cmath>
+
+namespace {
+
+// 并行求解时每块的天体数，是8通道的整数倍
+const size_t SOLVE_GRAIN = 8 * 1024;
+
+const float PI = 3.14159265358979f;
+const float TWO_PI = 6.28318530717959f;
+const float INV_TWO_PI = 0.159154943091895f;
+const float TWO_OVER_PI = 0.636619772367581f;
+
+// Cody-Waite拆分的π/2，前两项的低位为零，与小整数相乘没有舍入误差
+const float PIO2_1 = 1.5703125f;
+const float PIO2_2 = 4.837512969970703125e-4f;
+const float PIO2_3 = 7.54978995489188216e-8f;
+
+// 加上再减去1.5 * 2^23，按当前舍入模式取整到最近的整数，不需要分支或库函数
+inline float roundNearest(float v)
+{
+    const float magic = 12582912.0f;
+    return (v + magic) - magic;
+}
+
+// 把角度归约到[-π, π]
+inline float wrapAngle(float angle)
+{
+    return angle - TWO_PI * roundNearest(angle * INV_TWO_PI);
+}
+
+// 无分支的sin/cos，系数取自fdlibm的__kernel_sindf/__kernel_cosdf（|r| <= π/4）
+// 对|x|不超过几十个π的输入误差在2 ulp左右，足够求解开普勒方程
+inline void sinCos(float v, float& s, float& c)
+{
+    float k = roundNearest(v * TWO_OVER_PI);
+    float r = ((v - k * PIO2_1) - k * PIO2_2) - k * PIO2_3;
+    int quadrant = static_cast<int>(k) & 3;
+
+    float r2 = r * r;
+    float sr = r + r * r2 * (-0.166666666416265235595f + r2 * (0.0083333293858894631756f
+                   + r2 * (-0.000198393348360966317347f + r2 * 0.0000027183114939898219064f)));
+    float cr = 1.0f + r2 * (-0.499999997251031003120f + r2 * (0.0416666233237390631894f
+                   + r2 * (-0.00138867637746099294692f + r2 * 0.0000243904487962774090654f)));
+
+    // 按象限交换和取反
+    float sinValue = (quadrant & 1) ? cr : sr;
+    float cosValue = (quadrant & 1) ? sr : cr;
+    s = (quadrant & 2) ? -sinValue : sinValue;
+    c = ((quadrant + 1) & 2) ? -cosValue : cosValue;
+}
+
+// 求解核心，参数都标记为不重叠，编译器可以直接向量化整个循环
+void solveRange(const float* __restrict meanAnomaly, const float* __restrict ecc,
+                const float* __restrict pX, const float* __restrict pY, const float* __restrict pZ,
+                const float* __restrict qX, const float* __restrict qY, const float* __restrict qZ,
+                float* __restrict outX, float* __restrict outY, float* __restrict outZ,
+                size_t begin, size_t end)
+{
+    for (size_t i = begin; i < end; ++i) {
+        const float e = ecc[i];
+        const float m = wrapAngle(meanAnomaly[i]);
+
+        // Danby初值 E0 = M + 0.85 e sign(sin M)，M在[-π, π]内时sign(sin M) = sign(M)
+        float E = m + std::copysign(0.85f * e, m);
+
+        // 固定次数的Halley迭代：f = E - e sin E - M
+        for (int iteration = 0; iteration < KeplerBatch::HALLEY_ITERATIONS; ++iteration) {
+            float s, c;
+            sinCos(E, s, c);
+            float f = E - e * s - m;
+            float f1 = 1.0f - e * c;
+            float f2 = e * s;
+            E -= f * f1 / (f1 * f1 - 0.5f * f * f2);
+        }
+
+        float sinE, cosE;
+        sinCos(E, sinE, cosE);
+        const float u = cosE - e;
+        outX[i] = pX[i] * u + qX[i] * sinE;
+        outY[i] = pY[i] * u + qY[i] * sinE;
+        outZ[i] = pZ[i] * u + qZ[i] * sinE;
+    }
+}
+
+// f/g漂移中开普勒方程的Halley迭代次数
+const int DRIFT_ITERATIONS = 5;
+
+// 由轨道根数计算场景坐标下的基向量P（乘以a）和Q（乘以b），按double计算
+void orbitBasis(const OrbitalElements& elements, double p[3], double q[3])
+{
+    const double a = elements.semiMajorAxis;
+    const double e = elements.eccentricity;
+    const double b = a * std::sqrt(1.0 - e * e);
+
+    const double cosO = std::cos(double(elements.ascendingNode)), sinO = std::sin(double(elements.ascendingNode));
+    const double cosW = std::cos(double(elements.argumentOfPeriapsis)), sinW = std::sin(double(elements.argumentOfPeriapsis));
+    const double cosI = std::cos(double(elements.inclination)), sinI = std::sin(double(elements.inclination));
+
+    // 轨道平面基向量（黄道坐标）
+    const double pEcl[3] = { cosO * cosW - sinO * sinW * cosI, sinO * cosW + cosO * sinW * cosI, sinW * sinI };
+    const double qEcl[3] = { -cosO * sinW - sinO * cosW * cosI, -sinO * sinW + cosO * cosW * cosI, cosW * sinI };
+
+    // 黄道 (x, y, z) -> 场景 (x, z, -y)
+    p[0] = a * pEcl[0];
+    p[1] = a * pEcl[2];
+    p[2] = -a * pEcl[1];
+    q[0] = b * qEcl[0];
+    q[1] = b * qEcl[2];
+    q[2] = -b * qEcl[1];
+}
+
+} // namespace
+
+size_t KeplerBatch::Add(const OrbitalElements& elements)
+{
+    double p[3], q[3];
+    orbitBasis(elements, p, q);
+
+    eccentricity.push_back(elements.eccentricity);
+    px.push_back(static_cast<float>(p[0]));
+    py.push_back(static_cast<float>(p[1]));
+    pz.push_back(static_cast<float>(p[2]));
+    qx.push_back(static_cast<float>(q[0]));
+    qy.push_back(static_cast<float>(q[1]));
+    qz.push_back(static_cast<float>(q[2]));
+    x.push_back(0.0f);
+    y.push_back(0.0f);
+    z.push_back(0.0f);
+    return eccentricity.size() - 1;
+}
+
+void KeplerBatch::Clear()
+{
+    eccentricity.clear();
+    px.clear(); py.clear(); pz.clear();
+    qx.clear(); qy.clear(); qz.clear();
+    x.clear(); y.clear(); z.clear();
+}
+
+void KeplerBatch::Solve(const float* meanAnomaly, ThreadPool* pool)
+{
+    if (pool == nullptr) {
+        Solve(meanAnomaly, 0, Size());
+        return;
+    }
+    pool->ParallelFor(0, Size(), SOLVE_GRAIN, [this, meanAnomaly](size_t begin, size_t end) {
+        Solve(meanAnomaly, begin, end);
+    });
+}
+
+void KeplerBatch::Solve(const float* meanAnomaly, size_t begin, size_t end)
+{
+    solveRange(meanAnomaly, eccentricity.data(), px.data(), py.data(), pz.data(),
+               qx.data(), qy.data(), qz.data(), x.data(), y.data(), z.data(), begin, end);
+}
+
+size_t PreciseKeplerBatch::Add(const OrbitalElements& elements)
+{
+    double p[3], q[3];
+    orbitBasis(elements, p, q);
+
+    eccentricity.push_back(elements.eccentricity);
+    px.push_back(p[0]);
+    py.push_back(p[1]);
+    pz.push_back(p[2]);
+    qx.push_back(q[0]);
+    qy.push_back(q[1]);
+    qz.push_back(q[2]);
+    x.push_back(0.0);
+    y.push_back(0.0);
+    z.push_back(0.0);
+    return eccentricity.size() - 1;
+}
+
+void PreciseKeplerBatch::Clear()
+{
+    eccentricity.clear();
+    px.clear(); py.clear(); pz.clear();
+    qx.clear(); qy.clear(); qz.clear();
+    x.clear(); y.clear(); z.clear();
+}
+
+void PreciseKeplerBatch::Solve(const double* meanAnomaly)
+{
+    for (size_t i = 0; i < Size(); ++i) {
+        const double e = eccentricity[i];
+        double m = meanAnomaly[i];
+        m -= 6.283185307179586 * std::nearbyint(m * 0.15915494309189535);
+
+        // 与float版本相同的Danby初值和Halley迭代
+        double E = m + std::copysign(0.85 * e, m);
+        for (int iteration = 0; iteration < HALLEY_ITERATIONS; ++iteration) {
+            const double s = std::sin(E), c = std::cos(E);
+            const double f = E - e * s - m;
+            const double f1 = 1.0 - e * c;
+            const double f2 = e * s;
+            E -= f * f1 / (f1 * f1 - 0.5 * f * f2);
+        }
+
+        const double sinE = std::sin(E);
+        const double u = std::cos(E) - e;
+        x[i] = px[i] * u + qx[i] * sinE;
+        y[i] = py[i] * u + qy[i] * sinE;
+        z[i] = pz[i] * u + qz[i] * sinE;
+    }
+}
+
+void KeplerDrift(double* __restrict x, double* __restrict y, double* __restrict z,
+                 double* __restrict vx, double* __restrict vy, double* __restrict vz,
+                 size_t count, double mu, double dt)
+{
+    const double sqrtMu = std::sqrt(mu);
+    for (size_t i = 0; i < count; ++i) {
+        const double r0 = std::sqrt(x[i] * x[i] + y[i] * y[i] + z[i] * z[i]);
+        const double v2 = vx[i] * vx[i] + vy[i] * vy[i] + vz[i] * vz[i];
+        const double a = 1.0 / (2.0 / r0 - v2 / mu);
+        const double sqrtA = std::sqrt(a);
+        const double n = sqrtMu / (a * sqrtA);
+
+        // e cos E0 和 e sin E0
+        const double c = 1.0 - r0 / a;
+        const double s = (x[i] * vx[i] + y[i] * vy[i] + z[i] * vz[i]) / (sqrtMu * sqrtA);
+
+        // 运动是周期的，平近点角增量归约到[-π, π]，时间也相应缩短
+        double dM = n * dt;
+        dM -= 6.283185307179586 * std::nearbyint(dM * 0.15915494309189535);
+
+        // 从当前的偏近点角E0出发解普通的开普勒方程得到E1，再取 ΔE = E1 - E0；
+        // 用Danby初值，大偏心率时比直接以ΔM为初值稳定
+        const double e = std::sqrt(c * c + s * s);
+        const double E0 = std::atan2(s, c);
+        double M1 = E0 - s + dM;
+        M1 -= 6.283185307179586 * std::nearbyint(M1 * 0.15915494309189535);
+        double E1 = M1 + std::copysign(0.85 * e, M1);
+        for (int iteration = 0; iteration < DRIFT_ITERATIONS; ++iteration) {
+            const double sinE = std::sin(E1), cosE = std::cos(E1);
+            const double f = E1 - e * sinE - M1;
+            const double f1 = 1.0 - e * cosE;
+            const double f2 = e * sinE;
+            E1 -= f * f1 / (f1 * f1 - 0.5 * f * f2);
+        }
+
+        // ΔE与ΔM同在一个周期内
+        double dE = E1 - E0;
+        dE -= 6.283185307179586 * std::nearbyint((dE - dM) * 0.15915494309189535);
+
+        const double sinE = std::sin(dE), cosE = std::cos(dE);
+        const double r = a + (r0 - a) * cosE + s * a * sinE;
+        const double f = 1.0 - a / r0 * (1.0 - cosE);
+        const double g = (dM - dE + sinE) / n;
+        const double fDot = -std::sqrt(mu * a) / (r * r0) * sinE;
+        const double gDot = 1.0 - a / r * (1.0 - cosE);
+
+        const double px = x[i], py = y[i], pz = z[i];
+        x[i] = f * px + g * vx[i];
+        y[i] = f * py + g * vy[i];
+        z[i] = f * pz + g * vz[i];
+        vx[i] = fDot * px + gDot * vx[i];
+        vy[i] = fDot * py + gDot * vy[i];
+        vz[i] = fDot * pz + gDot * vz[i];
+    }
+}
@@ -5,13 +5,38 @@
 #include <fstream>
 #include <sstream>
 #include <iomanip> // 用于格式化输出
+#include <cstddef> // offsetof
+#include <algorithm>
+#include <random>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
 #include <GL/glew.h>
 #include <GLFW/glfw3.h>
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
+#include <glm/gtc/constants.hpp>
 
 #include "../include/text_renderer.h"
+#include "../include/trail_renderer.h"
+#include "../include/trail_history.h"
+#include "../include/frame_uniforms.h"
+#include "../include/frustum.h"
+#include "../include/simulation_clock.h"
+#include "../include/kepler.h"
+#include "../include/nbody.h"
+#include "../include/parallel_for.h"
+#include "../include/point_renderer.h"
+#include "../include/checksum.h"
+#include "../include/snapshot.h"
+#include "../include/asteroid_belt.h"
+#include "../include/star_catalog.h"
+#include "../include/star_renderer.h"
+#include "../include/ephemeris.h"
+#include "../include/sgp4.h"
+#include "../include/scene.h"
 
 #define STB_IMAGE_IMPLEMENTATION
 #include "stb_image.h"
@@ -24,18 +49,26 @@ const unsigned int SCR_HEIGHT = 720;
 float rotationSpeed = 1.0f;
 float orbitSpeed = 0.5f;
 
-// 相机控制参数
-glm::vec3 cameraPos = glm::vec3(0.0f, 100.0f, 230.0f);
-glm::vec3 cameraTarget = glm::vec3(0.0f, 0.0f, 0.0f);
-glm::vec3 cameraUp = glm::vec3(0.0f, 1.0f, 0.0f);
+// 时间倍率（方向键调节），每真实秒推进的模拟秒数
+double timeWarp = 1.0;
+const double MIN_TIME_WARP = 0.05;
+const double MAX_TIME_WARP = 1000.0;
+
+// 相机控制参数（双精度世界坐标，渲染时所有位置先减去相机位置再转为float）
+glm::dvec3 cameraPos = glm::dvec3(0.0, 100.0, 230.0);
+glm::dvec3 cameraTarget = glm::dvec3(0.0, 0.0, 0.0);
+glm::dvec3 cameraUp = glm::dvec3(0.0, 1.0, 0.0);
 float cameraZoom = 15.0f;
 
 // 默认相机参数（用于重置）
-const glm::vec3 DEFAULT_CAMERA_POS = glm::vec3(0.0f, 100.0f, 230.0f);
-const glm::vec3 DEFAULT_CAMERA_TARGET = glm::vec3(0.0f, 0.0f, 0.0f);
-const glm::vec3 DEFAULT_CAMERA_UP = glm::vec3(0.0f, 1.0f, 0.0f);
+const glm::dvec3 DEFAULT_CAMERA_POS = glm::dvec3(0.0, 100.0, 230.0);
+const glm::dvec3 DEFAULT_CAMERA_TARGET = glm::dvec3(0.0, 0.0, 0.0);
+const glm::dvec3 DEFAULT_CAMERA_UP = glm::dvec3(0.0, 1.0, 0.0);
 const float DEFAULT_CAMERA_ZOOM = 15.0f;
 
+// 近平面与远平面距离之比的下限，相机贴近天体表面时近平面也不会无限缩小
+const double MIN_NEAR_FAR_RATIO = 1e-7;
+
 // 鼠标控制参数
 bool firstMouse = true;
 float lastX = SCR_WIDTH / 2.0f;
@@ -52,6 +85,25 @@ int currentFont = 0;          // 当前使用的字体
 // 轨迹点最大数量
 const int MAX_TRAIL_POINTS = 200;
 
+// 模拟步长（秒），与帧率无关
+const double SIMULATION_STEP = 1.0 / 60.0;
+
+// 每单位速度每秒转过的弧度（等于原来60帧/秒下每帧0.01弧度）
+const float ANGLE_RATE = 0.6f;
+
+// 每个公转周期至少的模拟步数，时间倍率高时据此把一帧拆成多个子步
+const double STEPS_PER_ORBIT = 64.0;
+
+// 每帧用于模拟的CPU时间上限（秒），超出时丢弃剩余的子步，实际倍率随之下降
+const double SIMULATION_BUDGET = 0.008;
+
+// N体模式中碎片的数量和引力软化长度
+const int NBODY_DEBRIS = 1536;
+const double NBODY_SOFTENING = 0.01;
+
+// Barnes-Hut的张角（B键切换求解方式）
+const double BARNES_HUT_THETA = 0.5;
+
 // 字体路径
 const char* FONT_PATHS[] = {
     "fonts/Helvetica.ttc",
@@ -62,22 +114,121 @@ const char* FONT_PATHS[] = {
 struct Planet {
     std::string name;      // 行星名称
     float radius;          // 半径
-    float distance;        // 与太阳的距离
+    float distance;        // 轨道半长轴（与中心天体的平均距离）
+    float eccentricity;    // 轨道偏心率
+    float inclination;     // 轨道倾角（度，相对黄道）
+    float ascendingNode;   // 升交点黄经（度）
+    float argumentOfPeriapsis; // 近点幅角（度）
+    float mass;            // 质量（太阳质量，N体模式使用）
     float orbitSpeed;      // 公转速度
     float rotationSpeed;   // 自转速度
     float tilt;            // 轴倾角
-    float currentOrbitAngle; // 当前公转角度
+    double currentOrbitAngle; // 当前平近点角（弧度），double累加，远处行星的小增量不被舍掉
     float currentRotationAngle; // 当前自转角度
-    GLuint textureID;      // 纹理ID
-    std::vector<glm::vec3> trailPoints; // 轨迹点
+    double previousOrbitAngle = 0.0;    // 上一个模拟步的平近点角（用于插值）
+    float previousRotationAngle = 0.0f; // 上一个模拟步的自转角度（用于插值）
+    std::string texturePath; // 纹理文件
+    int textureLayer;      // 在纹理数组中的层号
+    bool emissive;         // 是否自发光（太阳）
+    TrailHistory trail;    // 轨迹点（环形缓冲）
+    int trailIndex;        // 在轨迹渲染器中的编号（-1表示没有轨迹）
+    unsigned int trailPending = 0; // 本帧新增、尚未上传到显存的轨迹点数
     float baseOrbitSpeed;    // 基础公转速度
     float baseRotationSpeed; // 基础自转速度
+    int parent = -1;         // 中心天体在planets中的编号（-1表示没有，位置即轨道位置）
+    int nbodyIndex = -1;     // 在N体系统中的编号（-1表示不参与N体计算，沿轨道跟随中心天体）
+    int ephemerisIndex = -1; // 在星历中的编号（-1表示星历中没有）
+    double ephemerisScale = 0.0; // 星历位置（AU）到场景坐标的缩放
+};
+
+// 每个天体实例的属性，与顶点着色器中的实例属性一一对应
+struct InstanceData {
+    glm::mat4 model;       // 模型矩阵
+    glm::mat3 normalMatrix; // 法线矩阵
+    float textureLayer;    // 纹理数组层号
+    float emissive;        // 自发光标志
 };
 
 // 全局变量
-GLuint trailShaderProgram;
-std::vector<Planet> planets;  // 行星数组改为全局变量
-Planet moon;                  // 月球也改为全局变量
+// 所有天体（太阳、行星和卫星）按层级排序：中心天体总在它的卫星之前，
+// 按顺序遍历一次即可由中心天体的位置得到所有卫星的位置
+std::vector<Planet> planets;
+
+// 所有天体的开普勒轨道，编号与planets一致，位置相对于各自的中心天体
+// 天体数很少，整批按double求解，外行星的位置不受float舍入影响
+PreciseKeplerBatch orbits;
+std::vector<double> meanAnomalies;
+
+// 所有天体的世界坐标，每个模拟步（用于轨迹）和每帧（插值后用于绘制）各按层级顺序计算一次
+std::vector<glm::dvec3> worldPositions;
+
+// 引力N体模式（N键切换）：太阳、行星和一圈碎片按真实引力运动，编号与planets一致，碎片排在后面
+bool nbodyMode = false;
+bool barnesHutMode = false;  // N体模式使用Barnes-Hut八叉树还是直接求和
+NBodySystem nbodySystem;
+std::vector<glm::dvec3> nbodyPrevious;  // 上一个模拟步的位置（用于插值）
+std::vector<glm::dvec3> nbodyCurrent;   // 当前模拟步的位置
+size_t nbodyMajorCount = 0;             // N体系统中太阳和行星的数量，之后都是碎片
+
+// 确定性模式（--deterministic）：步长固定，与时间倍率和帧率无关，每隔checksumInterval步输出一次状态校验和。
+// 同一程序在不同线程数下结果逐位一致；跨机器比较时需要用SOLAR_DETERMINISTIC构建（禁止FMA合并）
+bool deterministicMode = false;
+unsigned long long checksumInterval = 600;
+
+// 轨道时间：模拟时间乘以公转速度倍率，与N体模式的时间一致；小天体带和星历都由它解析求出位置
+double orbitTimePrevious = 0.0;  // 上一个模拟步的轨道时间（用于插值）
+double orbitTimeCurrent = 0.0;   // 当前模拟步的轨道时间
+
+// 小天体带（A键显示/隐藏）：主带在火星和木星之间，柯伊伯带在海王星之外，总数由--belt N设置。
+// 小天体只受太阳引力，沿固定的开普勒轨道运动
+AsteroidBelt asteroidBelt;
+size_t beltCount = 300000;
+bool showBelts = true;
+
+// 小天体带性能测试（--bench-belt）：依次用下列数量渲染固定帧数（关闭垂直同步），输出帧率后退出
+const size_t BELT_BENCH_COUNTS[] = { 10000, 100000, 300000, 1000000 };
+const int BELT_BENCH_WARMUP = 30;
+const int BELT_BENCH_FRAMES = 300;
+bool benchBelt = false;
+
+// 星历模式（E键切换）：行星位置取自切比雪夫星历文件（--ephemeris指定，默认为工作目录下的ephemeris.bin），
+// 能打开星历时默认开启。轨道时间0对应J2000，地球在场景中公转一周对应一年；
+// 场景中的轨道距离是压缩过的，各行星的日心位置按场景距离与星历中平均距离之比缩放，方向和偏心率不变
+const char* ephemerisPath = "ephemeris.bin";
+Ephemeris ephemeris;
+bool ephemerisMode = false;
+const double J2000_DAY = 2451545.0;
+const double DAYS_PER_YEAR = 365.25;
+double daysPerOrbitTime = 0.0;  // 每单位轨道时间对应的天数，由地球的公转速度确定
+
+// 人造卫星（S键显示/隐藏）：启动时读取TLE文件（--tle指定，默认为工作目录下的satellites.tle），
+// 每帧用SGP4在线程池上批量传播，画成环绕地球的点。卫星的时间与行星的轨道时间分开：
+// 模拟时间0对应文件中最新的历元，每模拟秒对应SATELLITE_MINUTES_PER_SECOND分钟，近地卫星在1倍速下约一分半钟绕地球一圈。
+// 位置按地球模型的半径缩放，并按地球模型的轴倾角转到场景中，赤道轨道落在绘制的地球赤道上。
+// 深空卫星（GPS、地球同步等）没有SDP4项，单独放在近似批次中，用另一种颜色绘制，HUD上标为近似位置
+const char* tlePath = "satellites.tle";
+Sgp4Batch satellites;
+Sgp4Batch deepSpaceSatellites(true);
+const glm::vec3 SATELLITE_COLOR(0.5f, 0.85f, 1.0f);
+const glm::vec3 DEEP_SPACE_SATELLITE_COLOR(1.0f, 0.5f, 0.2f);
+bool showSatellites = true;
+double satelliteEpoch = 0.0;
+const double SATELLITE_MINUTES_PER_SECOND = 60.0;
+const double SGP4_EARTH_RADIUS = 6378.135;   // WGS-72赤道半径（km），与SGP4一致
+
+// 场景文件（--scene指定）：天体的轨道根数、半径、纹理和层级，第一次读取后编译成同名的.cache文件，之后的启动直接映射
+const char* scenePath = "scenes/solar_system.scene";
+
+// 星空背景：启动时映射星表文件并一次性上传，[ ] 键调节极限星等
+const char* STAR_CATALOG_PATH = "stars.bin";
+float magnitudeLimit = 6.5f;
+const float MIN_MAGNITUDE_LIMIT = 0.0f;
+const float MAX_MAGNITUDE_LIMIT = 14.0f;
+
+// 快照文件（F5保存，F9读取）；按键只设置请求标志，在帧循环开始时处理
+const char* SNAPSHOT_PATH = "solar_system.snapshot";
+bool saveRequested = false;
+bool loadRequested = false;
 
 // 球体生成函数
 void generateSphere(std::vector<float>& vertices, std::vector<float>& normals, 
@@ -161,6 +312,81 @@ void generateSphere(std::vector<float>& vertices, std::vector<float>& normals,
     }
 }
 
+// 球体LOD层级：所有层级的网格存放在同一组缓冲区中
+struct SphereLOD {
+    GLsizei indexCount;    // 索引数量
+    size_t firstIndex;     // 在索引缓冲区中的起始位置
+    GLint baseVertex;      // 在顶点缓冲区中的起始顶点
+    float relativeError;   // 多边形与真实球面的最大偏差（占半径的比例）
+};
+
+// 各LOD层级的经线分段数，从很粗到很细（纬线分段数为其一半）
+const unsigned int SPHERE_LOD_SECTORS[] = { 8, 16, 36, 64, 128 };
+
+// 允许的最大屏幕空间误差（像素）
+const float MAX_SCREEN_ERROR = 0.5f;
+
+// 生成所有LOD层级的球体网格，拼接到同一组顶点数组中
+std::vector<SphereLOD> generateSphereLODs(std::vector<float>& vertices, std::vector<float>& normals,
+                                         std::vector<float>& texCoords, std::vector<unsigned int>& indices) {
+    std::vector<SphereLOD> lods;
+    std::vector<float> lodVertices, lodNormals, lodTexCoords;
+    std::vector<unsigned int> lodIndices;
+    
+    for (unsigned int sectors : SPHERE_LOD_SECTORS) {
+        generateSphere(lodVertices, lodNormals, lodTexCoords, lodIndices, 1.0f, sectors, sectors / 2);
+        
+        SphereLOD lod;
+        lod.indexCount = lodIndices.size();
+        lod.firstIndex = indices.size();
+        lod.baseVertex = vertices.size() / 3;
+        // 相邻顶点间弦的中点到球面的距离：1 - cos(pi / sectors)
+        lod.relativeError = 1.0f - cosf(M_PI / sectors);
+        lods.push_back(lod);
+        
+        vertices.insert(vertices.end(), lodVertices.begin(), lodVertices.end());
+        normals.insert(normals.end(), lodNormals.begin(), lodNormals.end());
+        texCoords.insert(texCoords.end(), lodTexCoords.begin(), lodTexCoords.end());
+        indices.insert(indices.end(), lodIndices.begin(), lodIndices.end());
+    }
+    
+    return lods;
+}
+
+// 根据投影到屏幕上的几何误差选择LOD：选误差不超过MAX_SCREEN_ERROR的最粗层级
+int selectSphereLOD(const std::vector<SphereLOD>& lods, float radius, float distance, float pixelsPerUnit) {
+    // 相机在球体内部或非常近时使用最细的层级
+    if (distance <= radius) {
+        return lods.size() - 1;
+    }
+    
+    for (size_t i = 0; i < lods.size(); ++i) {
+        float screenError = radius * lods[i].relativeError / distance * pixelsPerUnit;
+        if (screenError <= MAX_SCREEN_ERROR) {
+            return i;
+        }
+    }
+    return lods.size() - 1;
+}
+
+// 设置实例属性指针，从firstInstance个实例开始读取（需要先绑定VAO和实例缓冲区）
+void setInstanceAttributes(size_t firstInstance) {
+    const size_t base = firstInstance * sizeof(InstanceData);
+    
+    // 模型矩阵占用4个vec4位置
+    for (int column = 0; column < 4; ++column) {
+        glVertexAttribPointer(3 + column, 4, GL_FLOAT, GL_FALSE, sizeof(InstanceData), (void*)(base + offsetof(InstanceData, model) + column * sizeof(glm::vec4)));
+    }
+    
+    // 纹理层号和自发光标志合为一个vec2
+    glVertexAttribPointer(7, 2, GL_FLOAT, GL_FALSE, sizeof(InstanceData), (void*)(base + offsetof(InstanceData, textureLayer)));
+    
+    // 法线矩阵占用3个vec3位置
+    for (int column = 0; column < 3; ++column) {
+        glVertexAttribPointer(8 + column, 3, GL_FLOAT, GL_FALSE, sizeof(InstanceData), (void*)(base + offsetof(InstanceData, normalMatrix) + column * sizeof(glm::vec3)));
+    }
+}
+
 // 加载着色器代码
 std::string loadShaderSource(const char* filePath) {
     std::string shaderCode;
@@ -190,44 +416,63 @@ std::string loadShaderSource(const char* filePath) {
     return shaderCode;
 }
 
-// 加载纹理函数
-GLuint loadTexture(const char* path) {
+// 加载纹理数组函数，每个文件占一层，尺寸不一致的图片在GPU上缩放到统一大小
+GLuint loadTextureArray(const std::vector<std::string>& paths, int layerWidth, int layerHeight) {
     GLuint textureID;
     glGenTextures(1, &textureID);
-    glBindTexture(GL_TEXTURE_2D, textureID);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, textureID);
     
     // 设置纹理参数
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    
-    // 加载并生成纹理
-    int width, height, nrChannels;
-    unsigned char* data = stbi_load(path, &width, &height, &nrChannels, 0);
-    if (data) {
-        GLenum format, internalFormat;
-        if (nrChannels == 1) {
-            format = GL_RED;
-            internalFormat = GL_RED;
-        }
-        else if (nrChannels == 3) {
-            format = GL_RGB;
-            internalFormat = GL_RGB8;
-        }
-        else if (nrChannels == 4) {
-            format = GL_RGBA;
-            internalFormat = GL_RGBA8;
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    
+    // 分配所有层的存储空间
+    glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_RGBA8, layerWidth, layerHeight, paths.size(), 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+    
+    // 用于缩放的帧缓冲
+    GLuint fbos[2];
+    glGenFramebuffers(2, fbos);
+    
+    for (size_t layer = 0; layer < paths.size(); ++layer) {
+        // 加载图片，统一转换为RGBA
+        int width, height, nrChannels;
+        unsigned char* data = stbi_load(paths[layer].c_str(), &width, &height, &nrChannels, 4);
+        if (!data) {
+            std::cout << "Failed to load texture: " << paths[layer] << std::endl;
+            continue;
         }
+        
+        if (width == layerWidth && height == layerHeight) {
+            // 尺寸一致，直接上传到对应层
+            glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, layer, width, height, 1, GL_RGBA, GL_UNSIGNED_BYTE, data);
+        } else {
+            // 尺寸不一致，先上传为临时纹理，再用glBlitFramebuffer缩放到对应层
+            GLuint temp;
+            glGenTextures(1, &temp);
+            glBindTexture(GL_TEXTURE_2D, temp);
+            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
+            
+            glBindFramebuffer(GL_READ_FRAMEBUFFER, fbos[0]);
+            glFramebufferTexture2D(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, temp, 0);
+            glBindFramebuffer(GL_DRAW_FRAMEBUFFER, fbos[1]);
+            glFramebufferTextureLayer(GL_DRAW_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, textureID, 0, layer);
+            glBlitFramebuffer(0, 0, width, height, 0, 0, layerWidth, layerHeight, GL_COLOR_BUFFER_BIT, GL_LINEAR);
+            glBindFramebuffer(GL_FRAMEBUFFER, 0);
             
-        glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, width, height, 0, format, GL_UNSIGNED_BYTE, data);
-        glGenerateMipmap(GL_TEXTURE_2D);
+            glBindTexture(GL_TEXTURE_2D, 0);
+            glDeleteTextures(1, &temp);
+            glBindTexture(GL_TEXTURE_2D_ARRAY, textureID);
+        }
         
-        std::cout << "Texture loaded: " << path << " (" << width << "x" << height << ", " << nrChannels << " channels)" << std::endl;
-    } else {
-        std::cout << "Failed to load texture: " << path << std::endl;
+        std::cout << "Texture loaded: " << paths[layer] << " (" << width << "x" << height << ", " << nrChannels << " channels, layer " << layer << ")" << std::endl;
+        stbi_image_free(data);
     }
-    stbi_image_free(data);
+    
+    glDeleteFramebuffers(2, fbos);
+    glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
     
     return textureID;
 }
@@ -251,32 +496,32 @@ void mouseCallback(GLFWwindow* window, double xpos, double ypos) {
         float rotY = -xoffset * mouseSpeed * 0.01f;
         
         // 计算相机到目标的方向向量
-        glm::vec3 direction = normalize(cameraPos - cameraTarget);
+        glm::dvec3 direction = normalize(cameraPos - cameraTarget);
         
         // 计算相机右向量和上向量
-        glm::vec3 right = normalize(cross(cameraUp, direction));
-        glm::vec3 up = cross(direction, right);
+        glm::dvec3 right = normalize(cross(cameraUp, direction));
+        glm::dvec3 up = cross(direction, right);
         
         // 创建旋转矩阵
-        glm::mat4 rotMatrix = glm::rotate(glm::mat4(1.0f), rotY, cameraUp);
-        rotMatrix = glm::rotate(rotMatrix, rotX, right);
+        glm::dmat4 rotMatrix = glm::rotate(glm::dmat4(1.0), (double)rotY, cameraUp);
+        rotMatrix = glm::rotate(rotMatrix, (double)rotX, right);
         
         // 应用旋转
-        glm::vec4 newPos = rotMatrix * glm::vec4(cameraPos - cameraTarget, 1.0f);
-        cameraPos = cameraTarget + glm::vec3(newPos);
+        glm::dvec4 newPos = rotMatrix * glm::dvec4(cameraPos - cameraTarget, 1.0);
+        cameraPos = cameraTarget + glm::dvec3(newPos);
     }
     
     // 右键按下：平移视角
     if (rightMousePressed) {
         // 计算相机到目标的方向向量
-        glm::vec3 direction = normalize(cameraPos - cameraTarget);
+        glm::dvec3 direction = normalize(cameraPos - cameraTarget);
         
         // 计算相机右向量和上向量
-        glm::vec3 right = normalize(cross(cameraUp, direction));
-        glm::vec3 up = cross(direction, right);
+        glm::dvec3 right = normalize(cross(cameraUp, direction));
+        glm::dvec3 up = cross(direction, right);
         
         // 计算平移量
-        glm::vec3 pan = (-right * xoffset * mouseSpeed + up * yoffset * mouseSpeed) * 0.25f * cameraZoom / 45.0f;
+        glm::dvec3 pan = (-right * (double)xoffset + up * (double)yoffset) * (double)(mouseSpeed * 0.25f * cameraZoom / 45.0f);
         
         // 应用平移
         cameraPos += pan;
@@ -313,17 +558,9 @@ void scrollCallback(GLFWwindow* window, double xoffset, double yoffset) {
         cameraZoom = 25.0f;
 }
 
-// 更新所有行星速度
-void updatePlanetSpeeds() {
-    // 更新所有行星的公转和自转速度
-    for (size_t i = 0; i < planets.size(); i++) {
-        planets[i].orbitSpeed = planets[i].baseOrbitSpeed * orbitSpeed;
-        planets[i].rotationSpeed = planets[i].baseRotationSpeed * rotationSpeed;
-    }
-    
-    // 更新月球的速度
-    moon.orbitSpeed = moon.baseOrbitSpeed * orbitSpeed;
-    moon.rotationSpeed = moon.baseRotationSpeed * rotationSpeed;
+// 调整时间倍率并限制在允许范围内
+void scaleTimeWarp(double factor) {
+    timeWarp = std::min(std::max(timeWarp * factor, MIN_TIME_WARP), MAX_TIME_WARP);
 }
 
 // 键盘回调函数
@@ -332,32 +569,20 @@ void keyCallback(GLFWwindow* window, int key, int scancode, int action, int mods
         glfwSetWindowShouldClose(window, true);
     }
     
-    // 增加/减少旋转速度 (上下方向键)
+    // 上下方向键按10倍调节时间倍率
     if (key == GLFW_KEY_UP && (action == GLFW_PRESS || action == GLFW_REPEAT)) {
-        rotationSpeed += 0.1f;
-        orbitSpeed += 0.05f;
-        updatePlanetSpeeds();  // 更新所有行星速度
+        scaleTimeWarp(10.0);
     }
     if (key == GLFW_KEY_DOWN && (action == GLFW_PRESS || action == GLFW_REPEAT)) {
-        rotationSpeed -= 0.1f;
-        orbitSpeed -= 0.05f;
-        if (rotationSpeed < 0.1f) rotationSpeed = 0.1f;
-        if (orbitSpeed < 0.05f) orbitSpeed = 0.05f;
-        updatePlanetSpeeds();  // 更新所有行星速度
+        scaleTimeWarp(0.1);
     }
     
-    // 左右方向键控制运动速度
+    // 左右方向键按2倍调节时间倍率
     if (key == GLFW_KEY_RIGHT && (action == GLFW_PRESS || action == GLFW_REPEAT)) {
-        rotationSpeed *= 1.2f;
-        orbitSpeed *= 1.2f;
-        updatePlanetSpeeds();  // 更新所有行星速度
+        scaleTimeWarp(2.0);
     }
     if (key == GLFW_KEY_LEFT && (action == GLFW_PRESS || action == GLFW_REPEAT)) {
-        rotationSpeed *= 0.8f;
-        orbitSpeed *= 0.8f;
-        if (rotationSpeed < 0.05f) rotationSpeed = 0.05f;
-        if (orbitSpeed < 0.025f) orbitSpeed = 0.025f;
-        updatePlanetSpeeds();  // 更新所有行星速度
+        scaleTimeWarp(0.5);
     }
     
     // Ctrl键控制显示/隐藏行星名称
@@ -370,6 +595,47 @@ void keyCallback(GLFWwindow* window, int key, int scancode, int action, int mods
         currentFont = (currentFont + 1) % 2; // 在两种字体间切换
     }
     
+    // N键切换引力N体模式
+    if (key == GLFW_KEY_N && action == GLFW_PRESS) {
+        nbodyMode = !nbodyMode;
+    }
+    
+    // B键切换N体引力的求解方式
+    if (key == GLFW_KEY_B && action == GLFW_PRESS) {
+        barnesHutMode = !barnesHutMode;
+    }
+    
+    // A键显示/隐藏小天体带
+    if (key == GLFW_KEY_A && action == GLFW_PRESS) {
+        showBelts = !showBelts;
+    }
+    
+    // S键显示/隐藏人造卫星
+    if (key == GLFW_KEY_S && action == GLFW_PRESS) {
+        showSatellites = !showSatellites;
+    }
+    
+    // E键切换星历模式（需要已打开星历文件）
+    if (key == GLFW_KEY_E && action == GLFW_PRESS && ephemeris.IsOpen()) {
+        ephemerisMode = !ephemerisMode;
+    }
+    
+    // [ ] 键调节极限星等（每次0.5等）
+    if (key == GLFW_KEY_LEFT_BRACKET && (action == GLFW_PRESS || action == GLFW_REPEAT)) {
+        magnitudeLimit = std::max(magnitudeLimit - 0.5f, MIN_MAGNITUDE_LIMIT);
+    }
+    if (key == GLFW_KEY_RIGHT_BRACKET && (action == GLFW_PRESS || action == GLFW_REPEAT)) {
+        magnitudeLimit = std::min(magnitudeLimit + 0.5f, MAX_MAGNITUDE_LIMIT);
+    }
+    
+    // F5保存快照，F9读取快照
+    if (key == GLFW_KEY_F5 && action == GLFW_PRESS) {
+        saveRequested = true;
+    }
+    if (key == GLFW_KEY_F9 && action == GLFW_PRESS) {
+        loadRequested = true;
+    }
+    
     // R键重置相机视角
     if (key == GLFW_KEY_R && action == GLFW_PRESS) {
         cameraPos = DEFAULT_CAMERA_POS;
@@ -431,10 +697,13 @@ GLuint createShaderProgram(const char* vertexPath, const char* fragmentPath) {
     glDeleteShader(vertexShader);
     glDeleteShader(fragmentShader);
     
+    // 绑定每帧共享的uniform块
+    FrameUniforms::Attach(shaderProgram);
+    
     return shaderProgram;
 }
 
-// 将3D世界坐标转换为2D屏幕坐标
+// 将3D坐标（相对于相机）转换为2D屏幕坐标
 glm::vec2 world3DToScreen2D(const glm::vec3& worldPos, const glm::mat4& view, const glm::mat4& projection, const glm::vec4& viewport) {
     glm::vec4 clipSpacePos = projection * view * glm::vec4(worldPos, 1.0f);
     
@@ -451,101 +720,569 @@ glm::vec2 world3DToScreen2D(const glm::vec3& worldPos, const glm::mat4& view, co
     return screenPos;
 }
 
+// 计算法线矩阵，每个天体每帧只算一次
+glm::mat3 computeNormalMatrix(const glm::mat4& model, bool uniformScale) {
+    glm::mat3 m = glm::mat3(model);
+    if (uniformScale) {
+        // 只有旋转和均匀缩放时，transpose(inverse(m))与m方向相同，只需除掉缩放系数
+        return m * (1.0f / glm::length(m[0]));
+    }
+    return glm::transpose(glm::inverse(m));
+}
+
 // 计算行星名称的位置，使其与行星旋转方向一致
 glm::vec3 calculateNamePosition(const Planet& planet, const glm::vec3& planetPos) {
     // 在行星正上方显示文字
     return glm::vec3(planetPos.x, planetPos.y, planetPos.z - planet.radius * 1.0f);
 }
 
-// 添加轨迹点
-void addTrailPoint(Planet& planet, const glm::vec3& position) {
-    // 如果轨迹点数量超过最大值，移除最旧的点
-    if (planet.trailPoints.size() >= MAX_TRAIL_POINTS) {
-        planet.trailPoints.erase(planet.trailPoints.begin());
+// 添加轨迹点，写满后自动覆盖最旧的点；显存在每帧模拟结束后统一更新
+void addTrailPoint(Planet& planet, const glm::dvec3& position) {
+    planet.trail.Push(position);
+    planet.trailPending++;
+}
+
+// 把本帧新增的轨迹点上传到显存
+// 新增的点不多时只追加这几个点；时间倍率高、一帧内新增大量点时整条轨迹重写一次
+void flushTrail(TrailRenderer& trails, Planet& planet) {
+    if (planet.trailPending == 0) {
+        return;
+    }
+    if (planet.trailPending < planet.trail.Capacity() / 4) {
+        for (unsigned int i = planet.trail.Size() - planet.trailPending; i < planet.trail.Size(); i++) {
+            trails.Push(planet.trailIndex, planet.trail[i]);
+        }
+    } else {
+        trails.Upload(planet.trailIndex, planet.trail);
+    }
+    planet.trailPending = 0;
+}
+
+// 由天体的轨道参数构造开普勒根数
+OrbitalElements orbitalElements(const Planet& planet) {
+    return { planet.distance, planet.eccentricity, glm::radians(planet.inclination),
+             glm::radians(planet.ascendingNode), glm::radians(planet.argumentOfPeriapsis), static_cast<float>(planet.currentOrbitAngle) };
+}
+
+// 把角度平移到[-π, π]，上一步的角度同步平移
+template <typename T>
+void wrapAngle(T& current, T& previous) {
+    const T twoPi = glm::two_pi<T>();
+    if (current > glm::pi<T>() || current < -glm::pi<T>()) {
+        T turns = std::floor((current + glm::pi<T>()) / twoPi);
+        current -= turns * twoPi;
+        previous -= turns * twoPi;
+    }
+}
+
+// 推进一个天体的角度，并保存上一步的状态用于插值
+void advancePlanet(Planet& planet, float dt) {
+    planet.previousOrbitAngle = planet.currentOrbitAngle;
+    planet.previousRotationAngle = planet.currentRotationAngle;
+    planet.currentOrbitAngle += planet.orbitSpeed * ANGLE_RATE * dt;
+    planet.currentRotationAngle += planet.rotationSpeed * ANGLE_RATE * dt;
+    
+    // 平近点角和自转角保持在[-π, π]附近，避免float精度随时间下降；前后两步一起平移，插值不受影响
+    wrapAngle(planet.currentOrbitAngle, planet.previousOrbitAngle);
+    wrapAngle(planet.currentRotationAngle, planet.previousRotationAngle);
+}
+
+// 模拟步长的精度上限：最短公转周期的 1/STEPS_PER_ORBIT
+double accuracyStep() {
+    float fastest = 0.0f;
+    for (size_t i = 0; i < planets.size(); i++) {
+        fastest = std::max(fastest, planets[i].orbitSpeed);
+    }
+    return glm::two_pi<double>() / (fastest * ANGLE_RATE) / STEPS_PER_ORBIT;
+}
+
+// 在上一步与当前状态之间插值公转和自转角度
+double interpolatedOrbitAngle(const Planet& planet, float alpha) {
+    return planet.previousOrbitAngle + (planet.currentOrbitAngle - planet.previousOrbitAngle) * alpha;
+}
+
+float interpolatedRotationAngle(const Planet& planet, float alpha) {
+    return planet.previousRotationAngle + (planet.currentRotationAngle - planet.previousRotationAngle) * alpha;
+}
+
+// 用插值后的平近点角批量求解所有天体的轨道位置
+void solveOrbits(float alpha) {
+    for (size_t i = 0; i < planets.size(); i++) {
+        meanAnomalies[i] = interpolatedOrbitAngle(planets[i], alpha);
+    }
+    orbits.Solve(meanAnomalies.data());
+}
+
+// 天体相对于其中心天体的位置
+glm::dvec3 orbitPosition(size_t index) {
+    return glm::dvec3(orbits.X()[index], orbits.Y()[index], orbits.Z()[index]);
+}
+
+// 从N体系统取出当前位置
+void copyNBodyPositions(std::vector<glm::dvec3>& positions) {
+    positions.resize(nbodySystem.Size());
+    for (size_t i = 0; i < positions.size(); i++) {
+        positions[i] = glm::dvec3(nbodySystem.X()[i], nbodySystem.Y()[i], nbodySystem.Z()[i]);
+    }
+}
+
+// 按名称查找天体，找不到时返回-1
+int findBody(const std::string& name) {
+    for (size_t i = 0; i < planets.size(); i++) {
+        if (planets[i].name == name) {
+            return static_cast<int>(i);
+        }
     }
+    return -1;
+}
+
+// 把天体按层级重新排序（稳定排序，中心天体在前），并更新parent编号
+void sortBodiesByHierarchy() {
+    // 每个天体在层级中的深度：没有中心天体的为0
+    std::vector<int> depth(planets.size());
+    for (size_t i = 0; i < planets.size(); i++) {
+        for (int p = planets[i].parent; p >= 0; p = planets[p].parent) {
+            depth[i]++;
+        }
+    }
+    std::vector<size_t> order(planets.size());
+    for (size_t i = 0; i < order.size(); i++) {
+        order[i] = i;
+    }
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) { return depth[a] < depth[b]; });
     
-    // 添加新的轨迹点
-    planet.trailPoints.push_back(position);
+    std::vector<int> newIndex(planets.size());
+    for (size_t i = 0; i < order.size(); i++) {
+        newIndex[order[i]] = static_cast<int>(i);
+    }
+    std::vector<Planet> sorted;
+    sorted.reserve(planets.size());
+    for (size_t i : order) {
+        sorted.push_back(std::move(planets[i]));
+        if (sorted.back().parent >= 0) {
+            sorted.back().parent = newIndex[sorted.back().parent];
+        }
+    }
+    planets.swap(sorted);
+}
+
+// 为参与N体计算的天体（太阳和直接绕它公转的行星）按顺序分配N体编号，碎片排在它们之后
+void assignNBodyIndices() {
+    nbodyMajorCount = 0;
+    for (size_t i = 0; i < planets.size(); i++) {
+        bool major = planets[i].parent <= 0;
+        planets[i].nbodyIndex = major ? static_cast<int>(nbodyMajorCount++) : -1;
+    }
+}
+
+// 太阳的引力参数：取值使地球的周期与运动学模式一致；场景中没有地球时改用第一颗绕根公转的行星
+double sceneGravity() {
+    int reference = findBody("Earth");
+    for (size_t i = 1; reference < 0 && i < planets.size(); i++) {
+        if (planets[i].parent == 0 && planets[i].baseOrbitSpeed > 0.0f) {
+            reference = static_cast<int>(i);
+        }
+    }
+    if (reference < 0) {
+        return 1.0;
+    }
+    const Planet& earth = planets[reference];
+    const double earthMeanMotion = earth.baseOrbitSpeed * ANGLE_RATE;
+    return earthMeanMotion * earthMeanMotion * earth.distance * earth.distance * earth.distance;
 }
 
-// 绘制轨迹
-void drawTrail(const Planet& planet, const glm::mat4& view, const glm::mat4& projection) {
-    if (planet.trailPoints.size() < 2) {
+// 生成count个小天体：三分之二在火星和木星轨道之间的主带，其余在海王星之外的柯伊伯带
+// 场景中缺少火星、木星或海王星时不生成
+void buildBelts(size_t count) {
+    asteroidBelt = AsteroidBelt(sceneGravity());
+    const int marsIndex = findBody("Mars"), jupiterIndex = findBody("Jupiter"), neptuneIndex = findBody("Neptune");
+    if (marsIndex < 0 || jupiterIndex < 0 || neptuneIndex < 0) {
         return;
     }
-    
-    // 使用轨迹着色器
-    glUseProgram(trailShaderProgram);
-    
-    // 设置着色器全局变量
-    glUniformMatrix4fv(glGetUniformLocation(trailShaderProgram, "view"), 1, GL_FALSE, glm::value_ptr(view));
-    glUniformMatrix4fv(glGetUniformLocation(trailShaderProgram, "projection"), 1, GL_FALSE, glm::value_ptr(projection));
-    
-    // 创建临时VAO和VBO用于轨迹线渲染
-    GLuint trailVAO, trailVBO;
-    glGenVertexArrays(1, &trailVAO);
-    glGenBuffers(1, &trailVBO);
-    
-    glBindVertexArray(trailVAO);
-    glBindBuffer(GL_ARRAY_BUFFER, trailVBO);
-    
-    // 计算顶点数组大小
-    std::vector<float> trailVertices;
-    std::vector<float> trailColors;
-    
-    // 收集顶点和颜色数据
-    for (size_t i = 0; i < planet.trailPoints.size(); ++i) {
-        // 添加位置
-        trailVertices.push_back(planet.trailPoints[i].x);
-        trailVertices.push_back(planet.trailPoints[i].y);
-        trailVertices.push_back(planet.trailPoints[i].z);
-        
-        // 计算透明度，越新的点越不透明
-        float alpha = static_cast<float>(i) / planet.trailPoints.size();
-        
-        // 如果是相对于当前点180度之外的轨迹点，透明度设为0
-        if (i < planet.trailPoints.size() / 2) {
-            alpha = 0.0f;
+    const float mars = planets[marsIndex].distance;
+    const float jupiter = planets[jupiterIndex].distance;
+    const float neptune = planets[neptuneIndex].distance;
+    asteroidBelt.AddRing(count - count / 3, mars + 1.0f, jupiter - 1.0f, 0.15f, glm::radians(15.0f), 1);
+    asteroidBelt.AddRing(count / 3, neptune + 3.0f, neptune + 15.0f, 0.2f, glm::radians(20.0f), 2);
+}
+
+// 由当前的开普勒轨道建立N体系统
+// 太阳（层级的根）和直接绕它公转的行星参与N体计算。
+// 行星初速度由轨道位置对平近点角的差分乘以平均角速度得到。
+// 场景中卫星的轨道远大于行星的希尔半径，卫星不参与N体计算，仍沿运动学轨道跟随各自的行星
+void buildNBodySystem() {
+    const double gravity = sceneGravity();
+    nbodySystem = NBodySystem(gravity, NBODY_SOFTENING);
+    
+    // 平近点角前后各偏移h求解一次，差分得到 dr/dM
+    const double h = 1e-3;
+    std::vector<double> shifted(meanAnomalies);
+    std::vector<glm::dvec3> ahead(planets.size()), behind(planets.size());
+    for (size_t i = 0; i < planets.size(); i++) {
+        shifted[i] = planets[i].currentOrbitAngle + h;
+    }
+    orbits.Solve(shifted.data());
+    for (size_t i = 0; i < planets.size(); i++) {
+        ahead[i] = orbitPosition(i);
+        shifted[i] = planets[i].currentOrbitAngle - h;
+    }
+    orbits.Solve(shifted.data());
+    for (size_t i = 0; i < planets.size(); i++) {
+        behind[i] = orbitPosition(i);
+    }
+    solveOrbits(1.0f);
+    
+    // 太阳放在原点，速度抵消行星的总动量，使质心静止
+    glm::dvec3 momentum(0.0);
+    std::vector<glm::dvec3> velocities(planets.size(), glm::dvec3(0.0));
+    for (size_t i = 1; i < planets.size(); i++) {
+        if (planets[i].parent != 0) {
+            continue;
         }
-        
-        // 添加颜色（白色 + alpha）
-        trailColors.push_back(1.0f);  // R
-        trailColors.push_back(1.0f);  // G
-        trailColors.push_back(1.0f);  // B
-        trailColors.push_back(alpha); // A
+        double a = planets[i].distance;
+        double meanMotion = std::sqrt(gravity * (1.0 + planets[i].mass) / (a * a * a));
+        velocities[i] = (ahead[i] - behind[i]) / (2.0 * h) * meanMotion;
+        momentum += velocities[i] * (double)planets[i].mass;
     }
+    velocities[0] = -momentum / (double)planets[0].mass;
     
-    // 分配缓冲区内存
-    const size_t vertexDataSize = trailVertices.size() * sizeof(float);
-    const size_t colorDataSize = trailColors.size() * sizeof(float);
+    assignNBodyIndices();
+    for (size_t i = 0; i < planets.size(); i++) {
+        if (planets[i].nbodyIndex >= 0) {
+            glm::dvec3 p = orbitPosition(i);
+            nbodySystem.Add(planets[i].mass, p.x, p.y, p.z, velocities[i].x, velocities[i].y, velocities[i].z);
+        }
+    }
     
-    glBufferData(GL_ARRAY_BUFFER, vertexDataSize + colorDataSize, nullptr, GL_STATIC_DRAW);
+    // 火星与木星之间的一圈碎片，近圆轨道，固定随机种子保证每次相同
+    std::mt19937 random(12345);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    for (int i = 0; i < NBODY_DEBRIS; i++) {
+        double r = 16.5 + 1.5 * unit(random);
+        double angle = glm::two_pi<double>() * unit(random);
+        double height = 0.3 * (unit(random) - 0.5);
+        double speed = std::sqrt(gravity / r);
+        nbodySystem.Add(1e-9, r * std::cos(angle), height, -r * std::sin(angle),
+                        -speed * std::sin(angle), 0.0, -speed * std::cos(angle));
+    }
     
-    // 填充顶点和颜色数据
-    glBufferSubData(GL_ARRAY_BUFFER, 0, vertexDataSize, trailVertices.data());
-    glBufferSubData(GL_ARRAY_BUFFER, vertexDataSize, colorDataSize, trailColors.data());
+    nbodySystem.SetSolver(barnesHutMode ? GravitySolver::BarnesHut : GravitySolver::Direct, BARNES_HUT_THETA);
     
-    // 设置顶点属性指针
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
+    copyNBodyPositions(nbodyCurrent);
+    nbodyPrevious = nbodyCurrent;
+}
+
+// 清空所有轨迹（切换模式时位置会跳变）
+void clearTrails(TrailRenderer& trails) {
+    for (Planet& planet : planets) {
+        if (planet.trailIndex < 0) {
+            continue;
+        }
+        planet.trail.Clear();
+        planet.trailPending = 0;
+        trails.Clear(planet.trailIndex);
+    }
+}
+
+// N体系统中第i个天体在两个模拟步之间插值后的世界坐标
+glm::dvec3 nbodyPosition(size_t i, float alpha) {
+    return nbodyPrevious[i] + (nbodyCurrent[i] - nbodyPrevious[i]) * (double)alpha;
+}
+
+// 轨道时间对应的儒略日
+double ephemerisDay(double orbitTime) {
+    return J2000_DAY + orbitTime * daysPerOrbitTime;
+}
+
+// 天体在儒略日day相对于太阳的场景坐标，超出星历范围时返回false
+bool ephemerisPosition(const Planet& planet, double day, glm::dvec3& position) {
+    double p[3];
+    if (!ephemeris.Position(planet.ephemerisIndex, day, p)) {
+        return false;
+    }
+    // 黄道 (x, y, z) 映射为场景 (x, z, -y)，与KeplerBatch一致
+    position = glm::dvec3(p[0], p[2], -p[1]) * planet.ephemerisScale;
+    return true;
+}
+
+// 打开星历文件，把直接绕太阳公转的天体按名称对应到星历中的天体（地球对应地月质心）
+// 星历时间由地球的公转速度换算，场景中没有地球时不使用星历
+void loadEphemeris() {
+    const int earthIndex = findBody("Earth");
+    if (earthIndex < 0) {
+        return;
+    }
+    if (!ephemeris.Open(ephemerisPath)) {
+        std::cerr << "No ephemeris at " << ephemerisPath << " (create one with make_ephemeris)" << std::endl;
+        return;
+    }
+    const Planet& earth = planets[earthIndex];
+    daysPerOrbitTime = DAYS_PER_YEAR * earth.baseOrbitSpeed * ANGLE_RATE / glm::two_pi<double>();
+    
+    // 平均距离取整个星历范围内日心距离的最大值和最小值的平均
+    const int samples = 256;
+    for (Planet& planet : planets) {
+        planet.ephemerisIndex = planet.parent == 0 ? ephemeris.FindBody(planet.name.c_str()) : -1;
+        if (planet.ephemerisIndex < 0) {
+            continue;
+        }
+        double nearest = std::numeric_limits<double>::max(), farthest = 0.0;
+        for (int i = 0; i < samples; i++) {
+            double day = ephemeris.StartDay() + (ephemeris.EndDay() - ephemeris.StartDay()) * (i + 0.5) / samples;
+            double p[3];
+            ephemeris.Position(planet.ephemerisIndex, day, p);
+            double r = std::sqrt(p[0] * p[0] + p[1] * p[1] + p[2] * p[2]);
+            nearest = std::min(nearest, r);
+            farthest = std::max(farthest, r);
+        }
+        planet.ephemerisScale = planet.distance / (0.5 * (nearest + farthest));
+    }
+    ephemerisMode = true;
+    std::cout << "Ephemeris: " << ephemeris.BodyCount() << " bodies, JD " << std::fixed << std::setprecision(1)
+              << ephemeris.StartDay() << " - " << ephemeris.EndDay() << std::defaultfloat << std::endl;
+}
+
+// 读取场景文件，按顺序创建天体并登记轨迹，失败时返回false
+bool loadScene(TrailRenderer& trails) {
+    double start = glfwGetTime();
+    Scene scene;
+    std::string error;
+    if (!scene.Load(scenePath, error)) {
+        std::cerr << "Failed to load scene: " << error << std::endl;
+        return false;
+    }
+    planets.clear();
+    planets.reserve(scene.Size());
+    for (size_t i = 0; i < scene.Size(); i++) {
+        const SceneBody& body = scene.Bodies()[i];
+        Planet planet;
+        planet.name = body.name;
+        planet.radius = body.radius;
+        planet.distance = body.distance;
+        planet.eccentricity = body.eccentricity;
+        planet.inclination = body.inclination;
+        planet.ascendingNode = body.ascendingNode;
+        planet.argumentOfPeriapsis = body.argumentOfPeriapsis;
+        planet.mass = body.mass;
+        planet.baseOrbitSpeed = body.orbitSpeed;
+        planet.baseRotationSpeed = body.rotationSpeed;
+        planet.orbitSpeed = planet.baseOrbitSpeed * orbitSpeed;
+        planet.rotationSpeed = planet.baseRotationSpeed * rotationSpeed;
+        planet.tilt = body.tilt;
+        planet.currentOrbitAngle = glm::radians(static_cast<double>(body.meanAnomaly));
+        planet.currentRotationAngle = 0.0f;
+        planet.texturePath = body.texture;
+        planet.emissive = (body.flags & SCENE_BODY_EMISSIVE) != 0;
+        if (body.flags & SCENE_BODY_TRAIL) {
+            planet.trail = TrailHistory(MAX_TRAIL_POINTS);
+            planet.trailIndex = trails.AddTrail();
+        } else {
+            planet.trailIndex = -1;
+        }
+        planet.parent = body.parent;
+        planets.push_back(std::move(planet));
+    }
+    std::cout << "Scene: " << planets.size() << " bodies from " << scenePath << " (" << (scene.Compiled() ? "compiled" : "cached")
+              << ", " << (glfwGetTime() - start) * 1000.0 << " ms)" << std::endl;
+    return true;
+}
+
+// 读取TLE文件，近地卫星登记到SGP4批次，深空卫星登记到近似批次，时间原点取最新的历元
+void loadSatellites() {
+    std::vector<TwoLineElements> elements;
+    if (!LoadTwoLineElements(tlePath, elements)) {
+        std::cerr << "No satellite elements at " << tlePath << " (two-line element sets, e.g. from CelesTrak)" << std::endl;
+        return;
+    }
+    satellites.Clear();
+    deepSpaceSatellites.Clear();
+    size_t rejected = 0;
+    for (const TwoLineElements& tle : elements) {
+        Sgp4Batch& batch = Sgp4Batch::IsDeepSpace(tle) ? deepSpaceSatellites : satellites;
+        if (batch.Add(tle)) {
+            satelliteEpoch = std::max(satelliteEpoch, tle.epoch);
+        } else {
+            rejected++;
+        }
+    }
+    std::cout << "Satellites: " << satellites.Size() << " near-Earth from " << tlePath << ", " << deepSpaceSatellites.Size()
+              << " deep-space drawn as approximate (no SDP4 terms), " << rejected << " rejected" << std::endl;
+}
+
+// 按层级顺序计算所有天体的世界坐标（轨道位置需已按同一alpha求解）
+// 参与N体计算的天体直接取N体位置，星历模式下的行星取星历位置；其余天体在中心天体的世界坐标上加上自己的轨道位置，
+// 中心天体排在前面，它的世界坐标在这一遍中已经算好
+void updateWorldPositions(float alpha) {
+    worldPositions.resize(planets.size());
+    const double day = ephemerisDay(orbitTimePrevious + (orbitTimeCurrent - orbitTimePrevious) * alpha);
+    for (size_t i = 0; i < planets.size(); i++) {
+        const Planet& planet = planets[i];
+        if (nbodyMode && planet.nbodyIndex >= 0) {
+            worldPositions[i] = nbodyPosition(planet.nbodyIndex, alpha);
+        } else if (ephemerisMode && planet.ephemerisIndex >= 0 && ephemerisPosition(planet, day, worldPositions[i])) {
+            worldPositions[i] += worldPositions[planet.parent];
+        } else if (planet.parent >= 0) {
+            worldPositions[i] = worldPositions[planet.parent] + orbitPosition(i);
+        } else {
+            worldPositions[i] = orbitPosition(i);
+        }
+    }
+}
+
+// 所有天体当前模拟状态的校验和：运动学模式的角度，以及N体模式的位置和速度
+uint64_t simulationChecksum() {
+    StateChecksum checksum;
+    for (const Planet& planet : planets) {
+        checksum.Add(&planet.currentOrbitAngle, 1);
+        checksum.Add(&planet.currentRotationAngle, 1);
+    }
+    if (nbodyMode) {
+        checksum.Add(nbodySystem.Checksum());
+    }
+    return checksum.Value();
+}
+
+// 场景层级的哈希：天体数相同的两个场景，绕根公转的天体数（即N体天体数）也可能不同
+uint64_t sceneHierarchyHash() {
+    StateChecksum hash;
+    hash.Add(static_cast<uint64_t>(planets.size()));
+    for (const Planet& planet : planets) {
+        hash.Add(static_cast<uint64_t>(static_cast<int64_t>(planet.parent)));
+    }
+    return hash.Value();
+}
+
+// 把当前模拟状态拷贝到data（通常是回收的缓冲区）用于保存快照，文件在后台写出
+void captureSnapshot(SnapshotData& data, const SimulationClock& clock) {
+    data.flags = (nbodyMode ? SNAPSHOT_NBODY : 0) | (barnesHutMode ? SNAPSHOT_BARNES_HUT : 0);
+    data.steps = clock.Steps();
+    data.time = clock.Time();
+    data.orbitTime = orbitTimeCurrent;
+    data.sceneHash = sceneHierarchyHash();
+    for (const Planet& planet : planets) {
+        data.orbitAngles.push_back(planet.currentOrbitAngle);
+        data.rotationAngles.push_back(planet.currentRotationAngle);
+    }
     
-    glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)vertexDataSize);
-    glEnableVertexAttribArray(1);
+    if (nbodyMode) {
+        const size_t n = nbodySystem.Size();
+        data.gravity = nbodySystem.Gravity();
+        data.softening = nbodySystem.Softening();
+        data.theta = nbodySystem.Theta();
+        data.nbodyCount = n;
+        const double* components[] = { nbodySystem.X(), nbodySystem.Y(), nbodySystem.Z(),
+                                       nbodySystem.VX(), nbodySystem.VY(), nbodySystem.VZ(), nbodySystem.Mass() };
+        for (size_t k = 0; k < 7; k++) {
+            data.nbodyState.insert(data.nbodyState.end(), components[k], components[k] + n);
+        }
+    }
+}
+
+// 从快照恢复模拟状态：映射文件后直接从映射内存整段拷贝，不做解析
+bool restoreSnapshot(SimulationClock& clock, TrailRenderer& trails) {
+    double start = glfwGetTime();
+    SnapshotReader reader;
+    if (!reader.Open(SNAPSHOT_PATH)) {
+        std::cerr << "Failed to load snapshot: " << SNAPSHOT_PATH << std::endl;
+        return false;
+    }
+    // 天体数和层级都必须与当前场景一致，N体段至少要包含所有参与N体计算的天体，否则不改动任何状态
+    const SnapshotHeader& header = reader.Header();
+    assignNBodyIndices();
+    const bool nbodySnapshot = (header.flags & SNAPSHOT_NBODY) != 0;
+    if (header.bodyCount != planets.size() || header.sceneHash != sceneHierarchyHash()
+        || (nbodySnapshot && header.nbodyCount < nbodyMajorCount)) {
+        std::cerr << "Snapshot does not match this scene: " << SNAPSHOT_PATH << std::endl;
+        return false;
+    }
     
-    // 启用线宽
-    glLineWidth(1.5f);
+    // 运动学天体的角度，上一步与当前相同，恢复后第一帧不插值
+    const double* orbitAngles = reader.OrbitAngles();
+    const float* rotationAngles = reader.RotationAngles();
+    for (size_t i = 0; i < planets.size(); i++) {
+        Planet& planet = planets[i];
+        planet.currentOrbitAngle = planet.previousOrbitAngle = orbitAngles[i];
+        planet.currentRotationAngle = planet.previousRotationAngle = rotationAngles[i];
+    }
+    solveOrbits(1.0f);
+    
+    nbodyMode = nbodySnapshot;
+    barnesHutMode = (header.flags & SNAPSHOT_BARNES_HUT) != 0;
+    if (nbodyMode) {
+        nbodySystem = NBodySystem(header.gravity, header.softening);
+        nbodySystem.Assign(header.nbodyCount, reader.NBody(0), reader.NBody(1), reader.NBody(2),
+                           reader.NBody(3), reader.NBody(4), reader.NBody(5), reader.NBody(6));
+        nbodySystem.SetSolver(barnesHutMode ? GravitySolver::BarnesHut : GravitySolver::Direct, header.theta);
+        copyNBodyPositions(nbodyCurrent);
+        nbodyPrevious = nbodyCurrent;
+    }
     
-    // 绘制线条
-    glDrawArrays(GL_LINE_STRIP, 0, planet.trailPoints.size());
+    orbitTimePrevious = orbitTimeCurrent = header.orbitTime;
+    clock.Restore(header.steps, header.time);
+    clearTrails(trails);
+    std::cout << "Snapshot loaded: " << SNAPSHOT_PATH << " (step " << header.steps << ", "
+              << header.nbodyCount << " N-body bodies, " << (glfwGetTime() - start) * 1000.0 << " ms)" << std::endl;
+    return true;
+}
+
+// 推进一个模拟步：更新所有天体的角度或N体状态，并按模拟步记录轨迹点
+void stepSimulation(ThreadPool& pool, float dt) {
+    for (size_t i = 0; i < planets.size(); i++) {
+        advancePlanet(planets[i], dt);
+    }
+    solveOrbits(1.0f);
+    orbitTimePrevious = orbitTimeCurrent;
+    orbitTimeCurrent += dt * orbitSpeed;
+    
+    if (nbodyMode) {
+        // 公转速度倍率同样作用于N体的时间
+        nbodySystem.Step(dt * orbitSpeed, &pool);
+        nbodyPrevious.swap(nbodyCurrent);
+        copyNBodyPositions(nbodyCurrent);
+    }
     
-    // 清理资源
-    glBindVertexArray(0);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glDeleteVertexArrays(1, &trailVAO);
-    glDeleteBuffers(1, &trailVBO);
+    updateWorldPositions(1.0f);
+    for (size_t i = 0; i < planets.size(); i++) {
+        if (planets[i].trailIndex >= 0) { // 太阳没有轨迹
+            addTrailPoint(planets[i], worldPositions[i]);
+        }
+    }
 }
 
-int main() {
+int main(int argc, char** argv) {
+    // 命令行参数：--deterministic [--threads N] [--checksum-interval N] [--belt N] [--bench-belt] [--ephemeris file] [--tle file] [--scene file]
+    unsigned int simulationThreads = 0;
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--deterministic") == 0) {
+            deterministicMode = true;
+        } else if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            simulationThreads = static_cast<unsigned int>(std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--checksum-interval") == 0 && i + 1 < argc) {
+            checksumInterval = std::strtoull(argv[++i], nullptr, 10);
+            if (checksumInterval == 0) {
+                checksumInterval = 1;
+            }
+        } else if (std::strcmp(argv[i], "--belt") == 0 && i + 1 < argc) {
+            beltCount = std::strtoull(argv[++i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--bench-belt") == 0) {
+            benchBelt = true;
+        } else if (std::strcmp(argv[i], "--ephemeris") == 0 && i + 1 < argc) {
+            ephemerisPath = argv[++i];
+        } else if (std::strcmp(argv[i], "--tle") == 0 && i + 1 < argc) {
+            tlePath = argv[++i];
+        } else if (std::strcmp(argv[i], "--scene") == 0 && i + 1 < argc) {
+            scenePath = argv[++i];
+        } else {
+            std::cerr << "Usage: " << argv[0] << " [--deterministic] [--threads N] [--checksum-interval N] [--belt N] [--bench-belt] [--ephemeris file] [--tle file] [--scene file]" << std::endl;
+            return 1;
+        }
+    }
+#ifndef SOLAR_DETERMINISTIC
+    if (deterministicMode) {
+        std::cerr << "Warning: built without SOLAR_DETERMINISTIC, checksums are only comparable on the same build" << std::endl;
+    }
+#endif
+    
     // 初始化GLFW
     if (!glfwInit()) {
         std::cerr << "Failed to initialize GLFW" << std::endl;
@@ -597,16 +1334,24 @@ int main() {
     glEnable(GL_CULL_FACE);
     glCullFace(GL_BACK);
     
+    // 点的大小由着色器设置
+    glEnable(GL_PROGRAM_POINT_SIZE);
+    
+    // 创建每帧共享的uniform缓冲区
+    FrameUniforms frameUniforms;
+    FrameData frameData;
+    frameData.screen = glm::ortho(0.0f, static_cast<float>(SCR_WIDTH), 0.0f, static_cast<float>(SCR_HEIGHT));
+    
     // 创建文本渲染器
-    TextRenderer textRenderer(SCR_WIDTH, SCR_HEIGHT);
+    TextRenderer textRenderer;
     bool fontLoaded = false;
     
-    // 尝试加载字体
-    for (int i = 0; i < 2; ++i) {
+    // 预先加载所有字体到缓存中，之后切换字体不再重新光栅化
+    // 倒序加载，最后切换到的是第一个可用的字体
+    for (int i = 1; i >= 0; --i) {
         if (textRenderer.Load(FONT_PATHS[i], 24)) {
             fontLoaded = true;
             currentFont = i;
-            break;
         } else {
             std::cerr << "Failed to load font: " << FONT_PATHS[i] << std::endl;
         }
@@ -619,8 +1364,30 @@ int main() {
     // 创建着色器程序
     GLuint shaderProgram = createShaderProgram("shaders/vertex.glsl", "shaders/fragment.glsl");
     
-    // 创建轨迹着色器程序
-    trailShaderProgram = createShaderProgram("shaders/trail_vertex.glsl", "shaders/trail_fragment.glsl");
+    // 纹理采样器固定使用0号纹理单元
+    glUseProgram(shaderProgram);
+    glUniform1i(glGetUniformLocation(shaderProgram, "texture1"), 0);
+    
+    // 创建轨迹渲染器
+    TrailRenderer trailRenderer(MAX_TRAIL_POINTS);
+    
+    // 创建点渲染器（N体模式的碎片、小天体带和人造卫星）
+    PointRenderer pointRenderer;
+    std::vector<glm::vec3> debrisPoints;
+    std::vector<glm::vec3> beltPoints;
+    std::vector<glm::vec3> satellitePoints;
+    
+    // 映射星表并上传到显存；映射保留到程序结束，用于按极限星等确定绘制的前缀
+    StarRenderer starRenderer;
+    StarCatalog starCatalog;
+    double starStart = glfwGetTime();
+    if (starCatalog.Open(STAR_CATALOG_PATH)) {
+        starRenderer.Upload(starCatalog);
+        std::cout << "Star catalogue: " << starCatalog.Size() << " stars, loaded in "
+                  << (glfwGetTime() - starStart) * 1000.0 << " ms" << std::endl;
+    } else {
+        std::cerr << "No star catalogue at " << STAR_CATALOG_PATH << " (create one with make_starcat)" << std::endl;
+    }
     
     // 创建球体数据
     std::vector<float> vertices;
@@ -628,15 +1395,16 @@ int main() {
     std::vector<float> texCoords;
     std::vector<unsigned int> indices;
     
-    generateSphere(vertices, normals, texCoords, indices, 1.0f, 36, 18);
+    std::vector<SphereLOD> sphereLODs = generateSphereLODs(vertices, normals, texCoords, indices);
     
     // 创建顶点数组对象和顶点缓冲对象
-    GLuint VAO, VBO, EBO, texCoordsVBO, normalsVBO;
+    GLuint VAO, VBO, EBO, texCoordsVBO, normalsVBO, instanceVBO;
     glGenVertexArrays(1, &VAO);
     glGenBuffers(1, &VBO);
     glGenBuffers(1, &EBO);
     glGenBuffers(1, &texCoordsVBO);
     glGenBuffers(1, &normalsVBO);
+    glGenBuffers(1, &instanceVBO);
     
     glBindVertexArray(VAO);
     
@@ -658,6 +1426,14 @@ int main() {
     glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
     glEnableVertexAttribArray(2);
     
+    // 实例属性（位置3-10），每个实例前进一次
+    glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+    setInstanceAttributes(0);
+    for (int location = 3; location <= 10; ++location) {
+        glEnableVertexAttribArray(location);
+        glVertexAttribDivisor(location, 1);
+    }
+    
     // 索引
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
     glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), indices.data(), GL_STATIC_DRAW);
@@ -665,297 +1441,375 @@ int main() {
     glBindBuffer(GL_ARRAY_BUFFER, 0);
     glBindVertexArray(0);
     
-    // 加载行星纹理
-    
-    // 太阳 (增大半径)
-    Planet sun;
-    sun.name = "Sun";
-    sun.radius = 3.0f;   // 增大太阳半径
-    sun.distance = 0.0f;
-    sun.baseOrbitSpeed = 0.0f;
-    sun.baseRotationSpeed = 0.1f;
-    sun.orbitSpeed = sun.baseOrbitSpeed * orbitSpeed;
-    sun.rotationSpeed = sun.baseRotationSpeed * rotationSpeed;
-    sun.tilt = 0.0f;
-    sun.currentOrbitAngle = 0.0f;
-    sun.currentRotationAngle = 0.0f;
-    sun.textureID = loadTexture("texture/sun.jpg");
-    planets.push_back(sun);
-    
-    // 水星 (增大半径)
-    Planet mercury;
-    mercury.name = "Mercury";
-    mercury.radius = 0.6f;  // 增大水星半径
-    mercury.distance = 4.5f;
-    mercury.baseOrbitSpeed = 4.7f;
-    mercury.baseRotationSpeed = 0.017f;
-    mercury.orbitSpeed = mercury.baseOrbitSpeed * orbitSpeed;
-    mercury.rotationSpeed = mercury.baseRotationSpeed * rotationSpeed;
-    mercury.tilt = 0.03f;
-    mercury.currentOrbitAngle = 0.0f;
-    mercury.currentRotationAngle = 0.0f;
-    mercury.textureID = loadTexture("texture/mercury.jpg");
-    planets.push_back(mercury);
-    
-    // 金星 (增大半径)
-    Planet venus;
-    venus.name = "Venus";
-    venus.radius = 1.2f;   // 增大金星半径
-    venus.distance = 7.0f;
-    venus.baseOrbitSpeed = 3.5f;
-    venus.baseRotationSpeed = 0.004f;
-    venus.orbitSpeed = venus.baseOrbitSpeed * orbitSpeed;
-    venus.rotationSpeed = venus.baseRotationSpeed * rotationSpeed;
-    venus.tilt = 177.3f;
-    venus.currentOrbitAngle = 0.0f;
-    venus.currentRotationAngle = 0.0f;
-    venus.textureID = loadTexture("texture/venus.jpg");
-    planets.push_back(venus);
-    
-    // 地球 (增大半径)
-    Planet earth;
-    earth.name = "Earth";
-    earth.radius = 1.3f;   // 增大地球半径
-    earth.distance = 10.75f;
-    earth.baseOrbitSpeed = 3.0f;
-    earth.baseRotationSpeed = 1.0f;
-    earth.orbitSpeed = earth.baseOrbitSpeed * orbitSpeed;
-    earth.rotationSpeed = earth.baseRotationSpeed * rotationSpeed;
-    earth.tilt = 23.4f;
-    earth.currentOrbitAngle = 0.0f;
-    earth.currentRotationAngle = 0.0f;
-    earth.textureID = loadTexture("texture/earth.jpg");
-    planets.push_back(earth);
-    
-    // 月球 (增大半径)
-    moon.name = "Moon";
-    moon.radius = 0.3f;    // 增大月球半径
-    moon.distance = 2.f;  // 相对于地球的距离
-    moon.baseOrbitSpeed = 13.0f;
-    moon.baseRotationSpeed = 0.1f;
-    moon.orbitSpeed = moon.baseOrbitSpeed * orbitSpeed;
-    moon.rotationSpeed = moon.baseRotationSpeed * rotationSpeed;
-    moon.tilt = 6.7f;
-    moon.currentOrbitAngle = 0.0f;
-    moon.currentRotationAngle = 0.0f;
-    moon.textureID = loadTexture("texture/moon.jpg");
-    
-    // 火星 (增大半径)
-    Planet mars;
-    mars.name = "Mars";
-    mars.radius = 0.7f;    // 增大火星半径
-    mars.distance = 15.0f;
-    mars.baseOrbitSpeed = 2.4f;
-    mars.baseRotationSpeed = 0.97f;
-    mars.orbitSpeed = mars.baseOrbitSpeed * orbitSpeed;
-    mars.rotationSpeed = mars.baseRotationSpeed * rotationSpeed;
-    mars.tilt = 25.2f;
-    mars.currentOrbitAngle = 0.0f;
-    mars.currentRotationAngle = 0.0f;
-    mars.textureID = loadTexture("texture/mars.jpg");
-    planets.push_back(mars);
-    
-    // 木星 (增大半径)
-    Planet jupiter;
-    jupiter.name = "Jupiter";
-    jupiter.radius = 2.5f;   // 增大木星半径
-    jupiter.distance = 19.0f;
-    jupiter.baseOrbitSpeed = 1.3f;
-    jupiter.baseRotationSpeed = 2.4f;
-    jupiter.orbitSpeed = jupiter.baseOrbitSpeed * orbitSpeed;
-    jupiter.rotationSpeed = jupiter.baseRotationSpeed * rotationSpeed;
-    jupiter.tilt = 3.1f;
-    jupiter.currentOrbitAngle = 0.0f;
-    jupiter.currentRotationAngle = 0.0f;
-    jupiter.textureID = loadTexture("texture/jupiter.jpg");
-    planets.push_back(jupiter);
-    
-    // 土星 (增大半径)
-    Planet saturn;
-    saturn.name = "Saturn";
-    saturn.radius = 2.3f;    // 增大土星半径
-    saturn.distance = 25.0f;
-    saturn.baseOrbitSpeed = 0.97f;
-    saturn.baseRotationSpeed = 2.2f;
-    saturn.orbitSpeed = saturn.baseOrbitSpeed * orbitSpeed;
-    saturn.rotationSpeed = saturn.baseRotationSpeed * rotationSpeed;
-    saturn.tilt = 26.7f;
-    saturn.currentOrbitAngle = 0.0f;
-    saturn.currentRotationAngle = 0.0f;
-    saturn.textureID = loadTexture("texture/saturn.jpg");
-    planets.push_back(saturn);
-    
-    // 天王星 (增大半径)
-    Planet uranus;
-    uranus.name = "Uranus";
-    uranus.radius = 1.8f;    // 增大天王星半径
-    uranus.distance = 35.0f;
-    uranus.baseOrbitSpeed = 0.68f;
-    uranus.baseRotationSpeed = 1.4f;
-    uranus.orbitSpeed = uranus.baseOrbitSpeed * orbitSpeed;
-    uranus.rotationSpeed = uranus.baseRotationSpeed * rotationSpeed;
-    uranus.tilt = 97.8f;
-    uranus.currentOrbitAngle = 0.0f;
-    uranus.currentRotationAngle = 0.0f;
-    uranus.textureID = loadTexture("texture/uranus.jpg");
-    planets.push_back(uranus);
-    
-    // 海王星 (增大半径)
-    Planet neptune;
-    neptune.name = "Neptune";
-    neptune.radius = 1.8f;    // 增大海王星半径
-    neptune.distance = 45.0f;
-    neptune.baseOrbitSpeed = 0.54f;
-    neptune.baseRotationSpeed = 1.5f;
-    neptune.orbitSpeed = neptune.baseOrbitSpeed * orbitSpeed;
-    neptune.rotationSpeed = neptune.baseRotationSpeed * rotationSpeed;
-    neptune.tilt = 28.3f;
-    neptune.currentOrbitAngle = 0.0f;
-    neptune.currentRotationAngle = 0.0f;
-    neptune.textureID = loadTexture("texture/neptune.jpg");
-    planets.push_back(neptune);
+    // 读取场景中的天体
+    if (!loadScene(trailRenderer)) {
+        glfwTerminate();
+        return -1;
+    }
+    
+    // 按层级排序，使中心天体总在卫星之前，然后登记所有天体的轨道根数
+    sortBodiesByHierarchy();
+    for (size_t i = 0; i < planets.size(); i++) {
+        orbits.Add(orbitalElements(planets[i]));
+    }
+    meanAnomalies.resize(orbits.Size());
+    updateWorldPositions(1.0f);
+    
+    // 生成小天体带；性能测试从最少的数量开始，并关闭垂直同步
+    if (benchBelt) {
+        beltCount = BELT_BENCH_COUNTS[0];
+        showBelts = true;
+        glfwSwapInterval(0);
+    }
+    buildBelts(beltCount);
+    loadEphemeris();
+    loadSatellites();
+    const int earthBody = findBody("Earth");  // 排序后的编号，人造卫星围绕它绘制，场景中没有地球时不绘制
+    
+    // 加载行星纹理，所有天体共用一个纹理数组，相同的纹理只加载一层
+    std::vector<std::string> texturePaths;
+    for (size_t i = 0; i < planets.size(); i++) {
+        auto found = std::find(texturePaths.begin(), texturePaths.end(), planets[i].texturePath);
+        planets[i].textureLayer = found - texturePaths.begin();
+        if (found == texturePaths.end()) {
+            texturePaths.push_back(planets[i].texturePath);
+        }
+    }
+    GLuint textureArray = loadTextureArray(texturePaths, 2048, 1024);
+    
+    // 分配实例缓冲区，每帧只更新内容
+    std::vector<InstanceData> instances;
+    std::vector<int> instanceLODs;
+    std::vector<InstanceData> sortedInstances;
+    std::vector<size_t> lodCounts(sphereLODs.size());
+    instances.reserve(planets.size());
+    instanceLODs.reserve(planets.size());
+    glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+    glBufferData(GL_ARRAY_BUFFER, planets.size() * sizeof(InstanceData), NULL, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
     
     // 定义视口参数用于坐标转换
     glm::vec4 viewport(0, 0, SCR_WIDTH, SCR_HEIGHT);
     
-    // 存储行星位置
-    std::vector<glm::vec3> planetPositions(planets.size());
-    glm::vec3 moonPosition;
+    // 存储行星位置：双精度世界坐标，以及相对于相机的float偏移（用于绘制和显示名称）
+    std::vector<glm::dvec3> planetPositions(planets.size());
+    std::vector<glm::vec3> planetOffsets(planets.size());
 
-    // 设置光照参数
-    glm::vec3 lightPos = glm::vec3(0.0f, 0.0f, 0.0f);  // 光源在太阳的位置
+    // 设置光照参数（光源在太阳的位置，每帧随相机更新）
     glm::vec3 lightColor = glm::vec3(1.0f, 1.0f, 1.0f);
     float ambientStrength = 0.3f;
+    
+    // 创建保留的界面文字，内容变化时才重新排版
+    int speedText = textRenderer.CreateText();
+    int fontText = textRenderer.CreateText();
+    int nameText = textRenderer.CreateText();
+    int cameraText = textRenderer.CreateText();
+    int cullText = textRenderer.CreateText();
+    int timingText = textRenderer.CreateText();
+    int nbodyText = textRenderer.CreateText();
+    int ephemerisText = textRenderer.CreateText();
+    int satelliteText = textRenderer.CreateText();
+    textRenderer.SetText(cameraText, "Camera Control: Left-click (Rotate), Right-click (Pan), Scroll (Zoom), R (Reset)", 10.0f, 120.0f, 0.5f, glm::vec3(1.0f, 1.0f, 0.0f));
+    
+    // 界面上当前显示的值，用于判断是否需要重建文字
+    double shownTimeWarp = -1.0;
+    double shownAchievedWarp = -1.0;
+    int shownFont = -1;
+    int shownPlanetNames = -1;
+    int shownCullCounts[4] = { -1, -1, -1, -1 };
+    
+    // 每个天体本帧是否在视锥体内（用于跳过名称）
+    std::vector<bool> planetVisible(planets.size());
+    
+    // 固定步长的模拟时钟，以及模拟/渲染耗时统计（每0.5秒刷新一次显示）
+    SimulationClock simulationClock(SIMULATION_STEP);
+    ThreadPool simulationPool(simulationThreads);
+    bool nbodyActive = false;
+    bool ephemerisActive = ephemerisMode;
+    SnapshotWriter snapshotWriter;
+    double lastFrameTime = glfwGetTime();
+    double statsStartTime = lastFrameTime;
+    double simulationCost = 0.0;
+    double renderCost = 0.0;
+    int statsFrames = 0;
+    unsigned long long statsStartSteps = 0;
+    double statsStartSimulationTime = 0.0;
+    double achievedWarp = timeWarp;
+    unsigned long long statsStartInteractions = 0;
+    double beltCost = 0.0;
+    double satelliteCost = 0.0;
+    int benchIndex = 0;
+    int benchFrame = 0;
+    double benchStart = 0.0;
+    double benchBeltCost = 0.0;
 
     // 渲染循环
     while (!glfwWindowShouldClose(window)) {
+        // 保存快照：帧循环中只拷贝状态，写文件在后台线程进行
+        if (saveRequested) {
+            saveRequested = false;
+            if (snapshotWriter.Busy()) {
+                std::cerr << "Previous snapshot is still being written, save skipped" << std::endl;
+            } else {
+                SnapshotData data = snapshotWriter.Recycle();
+                captureSnapshot(data, simulationClock);
+                snapshotWriter.Save(SNAPSHOT_PATH, std::move(data));
+            }
+        }
+        
+        // 读取快照：恢复的模式直接生效，不再由当前轨道重建N体系统
+        if (loadRequested) {
+            loadRequested = false;
+            if (restoreSnapshot(simulationClock, trailRenderer)) {
+                nbodyActive = nbodyMode;
+                statsStartInteractions = nbodySystem.Interactions();
+            }
+        }
+        
+        // 切换N体模式：进入时由当前轨道建立N体系统，两种模式的位置不连续，清空轨迹
+        if (nbodyMode != nbodyActive) {
+            if (nbodyMode) {
+                buildNBodySystem();
+            }
+            clearTrails(trailRenderer);
+            statsStartInteractions = nbodySystem.Interactions();
+            nbodyActive = nbodyMode;
+        }
+        
+        // 切换星历模式：位置不连续，清空轨迹
+        if (ephemerisMode != ephemerisActive) {
+            clearTrails(trailRenderer);
+            ephemerisActive = ephemerisMode;
+        }
+        
+        // 切换引力求解方式
+        GravitySolver solver = barnesHutMode ? GravitySolver::BarnesHut : GravitySolver::Direct;
+        if (nbodySystem.Solver() != solver) {
+            nbodySystem.SetSolver(solver, BARNES_HUT_THETA);
+        }
+        
+        // 按真实经过的时间和时间倍率推进模拟
+        // 步长在一帧一步（倍率低时）和精度上限之间取较小者，倍率高时一帧拆成多个子步；
+        // 子步耗尽本帧的CPU预算后丢弃剩余部分，保证精度和帧率，实际达到的倍率显示在界面上
+        double frameStart = glfwGetTime();
+        // 确定性模式下步长固定为SIMULATION_STEP，时间倍率只改变每帧的步数
+        simulationClock.SetWarp(timeWarp);
+        if (!deterministicMode) {
+            simulationClock.SetStepSize(std::min(SIMULATION_STEP * timeWarp, accuracyStep()));
+        }
+        simulationClock.Advance(frameStart - lastFrameTime);
+        lastFrameTime = frameStart;
+        while (simulationClock.Step()) {
+            stepSimulation(simulationPool, static_cast<float>(simulationClock.StepSize()));
+            if (deterministicMode && simulationClock.Steps() % checksumInterval == 0) {
+                std::printf("step %llu checksum %016llx\n", simulationClock.Steps(),
+                            static_cast<unsigned long long>(simulationChecksum()));
+            }
+            if (glfwGetTime() - frameStart > SIMULATION_BUDGET) {
+                simulationClock.Drop();
+                break;
+            }
+        }
+        for (Planet& planet : planets) {
+            if (planet.trailIndex >= 0) {
+                flushTrail(trailRenderer, planet);
+            }
+        }
+        const float alpha = simulationClock.Alpha();
+        double renderStart = glfwGetTime();
+        simulationCost += renderStart - frameStart;
+        
         // 清空颜色和深度缓冲
         glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
         
-        // 如果需要切换字体
+        // 如果需要切换字体（字体已缓存，只是切换句柄）
         static int lastFont = currentFont;
         if (lastFont != currentFont) {
             textRenderer.Load(FONT_PATHS[currentFont], 24);
             lastFont = currentFont;
         }
         
-        // 更新相机视图矩阵
-        glm::mat4 view = glm::lookAt(cameraPos, cameraTarget, cameraUp);
-        glm::mat4 projection = glm::perspective(glm::radians(cameraZoom), (float)SCR_WIDTH / (float)SCR_HEIGHT, 0.1f, 1000.0f);
+        // 以双精度求出所有天体的世界坐标（在两个模拟步之间插值），再换成相对于相机的float偏移
+        // 卫星的位置由层级关系一遍求出
+        solveOrbits(alpha);
+        updateWorldPositions(alpha);
+        for (size_t i = 0; i < planets.size(); i++) {
+            planetPositions[i] = worldPositions[i];
+            planetOffsets[i] = glm::vec3(planetPositions[i] - cameraPos);
+        }
+        
+        // 根据天体与相机的距离确定近平面和远平面：
+        // 近平面取最近天体表面距离的一半，远平面覆盖整个系统（外侧行星的轨迹也在其中）
+        double nearestSurface = std::numeric_limits<double>::max();
+        double systemRadius = 0.0;
+        for (size_t i = 0; i < planets.size(); i++) {
+            nearestSurface = std::min(nearestSurface, glm::length(planetPositions[i] - cameraPos) - planets[i].radius);
+            systemRadius = std::max(systemRadius, glm::length(planetPositions[i] - planetPositions[0]) + planets[i].radius);
+        }
+        const double farPlane = (glm::length(planetPositions[0] - cameraPos) + systemRadius) * 1.1;
+        const double nearPlane = std::max(nearestSurface * 0.5, farPlane * MIN_NEAR_FAR_RATIO);
+        
+        // 更新相机视图矩阵：相机位于原点，视图矩阵只包含旋转
+        glm::mat4 view = glm::lookAt(glm::vec3(0.0f), glm::vec3(cameraTarget - cameraPos), glm::vec3(cameraUp));
+        glm::mat4 projection = glm::perspective(glm::radians(cameraZoom), (float)SCR_WIDTH / (float)SCR_HEIGHT, (float)nearPlane, (float)farPlane);
                 
-        // 设置着色器全局变量
-        glUseProgram(shaderProgram);
-        glUniformMatrix4fv(glGetUniformLocation(shaderProgram, "view"), 1, GL_FALSE, glm::value_ptr(view));
-        glUniformMatrix4fv(glGetUniformLocation(shaderProgram, "projection"), 1, GL_FALSE, glm::value_ptr(projection));
-        glUniform3fv(glGetUniformLocation(shaderProgram, "lightPos"), 1, glm::value_ptr(lightPos));
-        glUniform3fv(glGetUniformLocation(shaderProgram, "lightColor"), 1, glm::value_ptr(lightColor));
-        glUniform1f(glGetUniformLocation(shaderProgram, "ambientStrength"), ambientStrength);
-        glUniform1i(glGetUniformLocation(shaderProgram, "texture1"), 0);
+        // 上传本帧共享的着色器数据
+        frameData.view = view;
+        frameData.projection = projection;
+        frameData.lightPos = glm::vec4(planetOffsets[0], 1.0f);
+        frameData.lightColor = glm::vec4(lightColor, ambientStrength);
+        frameData.viewPos = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+        frameUniforms.Update(frameData);
         
-        glBindVertexArray(VAO);
+        // 最先绘制星空背景，只绘制不超过极限星等的恒星
+        const size_t visibleStars = starCatalog.CountBrighterThan(magnitudeLimit);
+        starRenderer.Draw(visibleStars, magnitudeLimit);
+        
+        // 本帧的视锥体（相对于相机的坐标系），用于裁剪天体、轨迹和名称
+        Frustum frustum(projection * view);
+        
+        // 世界空间中一个单位在屏幕上对应的像素数（乘以1/距离），用于选择LOD
+        float pixelsPerUnit = SCR_HEIGHT / (2.0f * tanf(glm::radians(cameraZoom) * 0.5f));
         
-        // 更新和渲染每个行星
+        // 收集每个天体的实例数据
+        instances.clear();
+        instanceLODs.clear();
         for (size_t i = 0; i < planets.size(); i++) {
-            planets[i].currentOrbitAngle += planets[i].orbitSpeed * 0.01f;
-            planets[i].currentRotationAngle += planets[i].rotationSpeed * 0.01f;
-            
-            glm::mat4 model = glm::mat4(1.0f);
-            
-            // 进行公转
-            model = glm::rotate(model, planets[i].currentOrbitAngle, glm::vec3(0.0f, 1.0f, 0.0f));
-            model = glm::translate(model, glm::vec3(planets[i].distance, 0.0f, 0.0f));
+            // 移动到轨道位置
+            glm::mat4 model = glm::translate(glm::mat4(1.0f), planetOffsets[i]);
             model = glm::rotate(model, glm::radians(-90.0f), glm::vec3(1.0f, 0.0f, 0.0f));
             
-            // 保存未旋转的行星位置（用于显示名称和绘制轨迹）
-            planetPositions[i] = glm::vec3(model[3]);
-            
-            // 添加轨迹点
-            if (i > 0) { // 太阳不需要轨迹
-                addTrailPoint(planets[i], planetPositions[i]);
-            }
-            
             // 进行自转
             model = glm::rotate(model, glm::radians(planets[i].tilt), glm::vec3(0.0f, 1.0f, 0.0f));
-            model = glm::rotate(model, planets[i].currentRotationAngle, glm::vec3(0.0f, 0.0f, 1.0f));
+            model = glm::rotate(model, interpolatedRotationAngle(planets[i], alpha), glm::vec3(0.0f, 0.0f, 1.0f));
             
             // 设置行星大小
             model = glm::scale(model, glm::vec3(planets[i].radius));
             
-            // 传递模型矩阵到着色器
-            glUniformMatrix4fv(glGetUniformLocation(shaderProgram, "model"), 1, GL_FALSE, glm::value_ptr(model));
-            
-            // 设置isSun标志，太阳(i=0)为true，其他行星为false
-            glUniform1i(glGetUniformLocation(shaderProgram, "isSun"), i == 0 ? 1 : 0);
-            
-            // 绑定纹理
-            glActiveTexture(GL_TEXTURE0);
-            glBindTexture(GL_TEXTURE_2D, planets[i].textureID);
-            glUniform1i(glGetUniformLocation(shaderProgram, "texture1"), 0);
-            
-            // 绘制行星
-            glDrawElements(GL_TRIANGLES, indices.size(), GL_UNSIGNED_INT, 0);
-            
-            // 特殊处理：地球的月球
-            if (i == 3) {  // 地球是第四个行星（索引为3）
-                glm::mat4 moonModel = glm::mat4(1.0f);
-                
-                // 地球的位置
-                moonModel = glm::rotate(moonModel, planets[i].currentOrbitAngle, glm::vec3(0.0f, 1.0f, 0.0f));
-                moonModel = glm::translate(moonModel, glm::vec3(planets[i].distance, 0.0f, 0.0f));
-                
-                // 月球围绕地球旋转
-                moonModel = glm::rotate(moonModel, moon.currentOrbitAngle, glm::vec3(0.0f, 1.0f, 0.0f));
-                moonModel = glm::translate(moonModel, glm::vec3(moon.distance, 0.0f, 0.0f));
-                moonModel = glm::rotate(moonModel, glm::radians(-90.0f), glm::vec3(1.0f, 0.0f, 0.0f));
-                
-                // 保存月球位置（用于显示名称和绘制轨迹）
-                moonPosition = glm::vec3(moonModel[3]);
-                
-                // 添加月球轨迹点
-                addTrailPoint(moon, moonPosition);
-                
-                // 月球自转
-                moonModel = glm::rotate(moonModel, glm::radians(moon.tilt), glm::vec3(1.0f, 0.0f, 0.0f));
-                moonModel = glm::rotate(moonModel, moon.currentRotationAngle, glm::vec3(0.0f, 1.0f, 0.0f));
-                
-                // 设置月球大小
-                moonModel = glm::scale(moonModel, glm::vec3(moon.radius));
-                
-                // 传递模型矩阵到着色器
-                glUniformMatrix4fv(glGetUniformLocation(shaderProgram, "model"), 1, GL_FALSE, glm::value_ptr(moonModel));
-                
-                // 设置isSun为false（月球不是太阳）
-                glUniform1i(glGetUniformLocation(shaderProgram, "isSun"), 0);
-                
-                // 绑定月球纹理
-                glActiveTexture(GL_TEXTURE0);
-                glBindTexture(GL_TEXTURE_2D, moon.textureID);
-                glUniform1i(glGetUniformLocation(shaderProgram, "texture1"), 0);
-                
-                // 绘制月球
-                glDrawElements(GL_TRIANGLES, indices.size(), GL_UNSIGNED_INT, 0);
-                
-                // 更新月球角度
-                moon.currentOrbitAngle += moon.orbitSpeed * 0.01f;
-                moon.currentRotationAngle += moon.rotationSpeed * 0.01f;
+            // 行星只做均匀缩放；不在视锥体内的行星不提交绘制，但仍然更新运动和轨迹
+            planetVisible[i] = frustum.IntersectsSphere(planetOffsets[i], planets[i].radius);
+            if (planetVisible[i]) {
+                instances.push_back({ model, computeNormalMatrix(model, true), (float)planets[i].textureLayer, planets[i].emissive ? 1.0f : 0.0f });
+                instanceLODs.push_back(selectSphereLOD(sphereLODs, planets[i].radius, glm::length(planetOffsets[i]), pixelsPerUnit));
             }
         }
         
-        // 绘制行星轨迹
-        for (size_t i = 1; i < planets.size(); i++) {  // 从1开始，太阳没有轨迹
-            drawTrail(planets[i], view, projection);
+        // 按LOD分组排列实例（计数排序）
+        std::fill(lodCounts.begin(), lodCounts.end(), 0);
+        for (int lod : instanceLODs) {
+            lodCounts[lod]++;
+        }
+        size_t lodOffsets[sizeof(SPHERE_LOD_SECTORS) / sizeof(SPHERE_LOD_SECTORS[0])];
+        for (size_t lod = 0, offset = 0; lod < sphereLODs.size(); ++lod) {
+            lodOffsets[lod] = offset;
+            offset += lodCounts[lod];
         }
+        sortedInstances.resize(instances.size());
+        for (size_t i = 0; i < instances.size(); ++i) {
+            sortedInstances[lodOffsets[instanceLODs[i]]++] = instances[i];
+        }
+        
+        // 上传实例数据
+        glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+        glBufferSubData(GL_ARRAY_BUFFER, 0, sortedInstances.size() * sizeof(InstanceData), sortedInstances.data());
         
-        // 绘制月球轨迹
-        drawTrail(moon, view, projection);
+        // 每个用到的LOD层级一次实例化绘制
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, textureArray);
+        glUseProgram(shaderProgram);
+        glBindVertexArray(VAO);
+        for (size_t lod = 0, first = 0; lod < sphereLODs.size(); first += lodCounts[lod], ++lod) {
+            if (lodCounts[lod] == 0) {
+                continue;
+            }
+            setInstanceAttributes(first);
+            glDrawElementsInstancedBaseVertex(GL_TRIANGLES, sphereLODs[lod].indexCount, GL_UNSIGNED_INT,
+                                              (void*)(sphereLODs[lod].firstIndex * sizeof(unsigned int)),
+                                              lodCounts[lod], sphereLODs[lod].baseVertex);
+        }
+        glBindVertexArray(0);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        
+        // 按分段包围盒裁剪轨迹，然后绘制行星和卫星轨迹（轨迹原点先换算到相对于相机的位置）
+        int visibleTrails = 0;
+        int totalTrails = 0;
+        for (size_t i = 0; i < planets.size(); i++) {
+            if (planets[i].trailIndex < 0) {
+                continue;
+            }
+            glm::vec3 offset(planets[i].trail.Origin() - cameraPos);
+            bool visible = planets[i].trail.Intersects(frustum, offset);
+            trailRenderer.SetVisible(planets[i].trailIndex, visible);
+            trailRenderer.SetOffset(planets[i].trailIndex, offset);
+            visibleTrails += visible ? 1 : 0;
+            totalTrails++;
+        }
+        trailRenderer.Draw();
+        
+        // 绘制N体模式的碎片
+        if (nbodyMode) {
+            debrisPoints.clear();
+            for (size_t i = nbodyMajorCount; i < nbodyCurrent.size(); i++) {
+                debrisPoints.push_back(glm::vec3(nbodyPosition(i, alpha) - cameraPos));
+            }
+            pointRenderer.Draw(debrisPoints.data(), debrisPoints.size(), glm::vec3(0.7f, 0.65f, 0.6f), 2.0f);
+        }
+        
+        // 绘制小天体带：按插值后的轨道时间并行求解，相对于太阳的位置加上太阳的相机偏移，一次上传、一次绘制
+        if (showBelts && asteroidBelt.Size() > 0) {
+            double beltStart = glfwGetTime();
+            double beltTime = orbitTimePrevious + (orbitTimeCurrent - orbitTimePrevious) * alpha;
+            beltPoints.resize(asteroidBelt.Size());
+            asteroidBelt.Evaluate(beltTime, planetOffsets[0].x, planetOffsets[0].y, planetOffsets[0].z,
+                                  glm::value_ptr(beltPoints[0]), &simulationPool);
+            double cost = glfwGetTime() - beltStart;
+            beltCost += cost;
+            benchBeltCost += cost;
+            pointRenderer.Draw(beltPoints.data(), beltPoints.size(), glm::vec3(0.6f, 0.58f, 0.55f), 1.5f);
+        }
+        
+        // 绘制人造卫星：按插值后的模拟时间并行传播，地心的TEME坐标缩放并转到地球模型的赤道坐标系，加上地球的相机偏移。
+        // 近地卫星和近似传播的深空卫星分两批，用不同颜色绘制
+        if (showSatellites && satellites.Size() + deepSpaceSatellites.Size() > 0 && earthBody >= 0) {
+            double seconds = simulationClock.Time() - (1.0 - alpha) * simulationClock.StepSize();
+            const double day = satelliteEpoch + seconds * SATELLITE_MINUTES_PER_SECOND / 1440.0;
+            glm::mat4 equator = glm::rotate(glm::mat4(1.0f), glm::radians(-90.0f), glm::vec3(1.0f, 0.0f, 0.0f));
+            equator = glm::rotate(equator, glm::radians(planets[earthBody].tilt), glm::vec3(0.0f, 1.0f, 0.0f));
+            const glm::mat3 frame = glm::mat3(equator) * static_cast<float>(planets[earthBody].radius / SGP4_EARTH_RADIUS);
+            Sgp4Batch* batches[] = { &satellites, &deepSpaceSatellites };
+            const glm::vec3 colors[] = { SATELLITE_COLOR, DEEP_SPACE_SATELLITE_COLOR };
+            for (int b = 0; b < 2; b++) {
+                Sgp4Batch& batch = *batches[b];
+                if (batch.Size() == 0) {
+                    continue;
+                }
+                double satelliteStart = glfwGetTime();
+                batch.Propagate(day, &simulationPool);
+                const double* x = batch.X();
+                const double* y = batch.Y();
+                const double* z = batch.Z();
+                satellitePoints.resize(batch.Size());
+                for (size_t i = 0; i < batch.Size(); i++) {
+                    satellitePoints[i] = planetOffsets[earthBody] + frame * glm::vec3(x[i], y[i], z[i]);
+                }
+                satelliteCost += glfwGetTime() - satelliteStart;
+                pointRenderer.Draw(satellitePoints.data(), satellitePoints.size(), colors[b], 1.5f);
+            }
+        }
         
         // 如果需要显示行星名称
+        int visibleLabels = 0;
         if (showPlanetNames) {
-            // 渲染行星名称
+            // 渲染行星名称，跳过被裁剪的行星
             for (size_t i = 0; i < planets.size(); i++) {
+                if (!planetVisible[i]) {
+                    continue;
+                }
+                visibleLabels++;
+                
                 // 计算符合行星旋转方向的文字位置
-                glm::vec3 namePos = calculateNamePosition(planets[i], planetPositions[i]);
+                glm::vec3 namePos = calculateNamePosition(planets[i], planetOffsets[i]);
                 
                 // 将3D世界坐标转换为2D屏幕坐标
                 glm::vec2 screenPos = world3DToScreen2D(namePos, view, projection, viewport);
@@ -966,32 +1820,143 @@ int main() {
                 // 渲染行星名称
                 textRenderer.RenderText(planets[i].name, screenPos.x - textWidth, screenPos.y, 0.5f, glm::vec3(1.0f, 1.0f, 1.0f));
             }
-            
-            // 渲染月球名称
-            // 计算符合月球旋转方向的文字位置
-            glm::vec3 moonNamePos = calculateNamePosition(moon, moonPosition);
-            glm::vec2 moonScreenPos = world3DToScreen2D(moonNamePos, view, projection, viewport);
-            float moonTextWidth = moon.name.length() * 12.0f * 0.5f; // 估计文本宽度
-            textRenderer.RenderText(moon.name, moonScreenPos.x - moonTextWidth, moonScreenPos.y, 0.5f, glm::vec3(1.0f, 1.0f, 1.0f));
         }
         
-        // 渲染控制信息，保留2位小数
-        std::stringstream speedStream;
-        speedStream << std::fixed << std::setprecision(2) << "Rotation Speed: " << rotationSpeed << " (Up/Down/Left/Right Keys)";
-        textRenderer.RenderText(speedStream.str(), 10.0f, 30.0f, 0.5f, glm::vec3(1.0f, 1.0f, 0.0f));
+        // 更新控制信息，只在显示的值变化时重建字符串（保留2位小数）
+        if (timeWarp != shownTimeWarp || achievedWarp != shownAchievedWarp) {
+            std::stringstream speedStream;
+            speedStream << std::fixed << std::setprecision(2) << "Time Warp: " << timeWarp << "x (achieved "
+                        << achievedWarp << "x, step " << std::setprecision(4) << simulationClock.StepSize()
+                        << " s, Up/Down: x10, Left/Right: x2)";
+            textRenderer.SetText(speedText, speedStream.str(), 10.0f, 30.0f, 0.5f, glm::vec3(1.0f, 1.0f, 0.0f));
+            shownTimeWarp = timeWarp;
+            shownAchievedWarp = achievedWarp;
+        }
+        
+        if (currentFont != shownFont) {
+            std::string fontInfo = "Current Font: " + std::string(currentFont == 0 ? "Helvetica" : "MarkerFelt") + " (Press F to change)";
+            textRenderer.SetText(fontText, fontInfo, 10.0f, 60.0f, 0.5f, glm::vec3(1.0f, 1.0f, 0.0f));
+            shownFont = currentFont;
+        }
+        
+        if (showPlanetNames != shownPlanetNames) {
+            std::string nameInfo = "Planet Names: " + std::string(showPlanetNames ? "Shown" : "Hidden") + " (Press Ctrl to toggle)";
+            textRenderer.SetText(nameText, nameInfo, 10.0f, 90.0f, 0.5f, glm::vec3(1.0f, 1.0f, 0.0f));
+            shownPlanetNames = showPlanetNames;
+        }
         
-        std::string fontInfo = "Current Font: " + std::string(currentFont == 0 ? "Helvetica" : "MarkerFelt") + " (Press F to change)";
-        textRenderer.RenderText(fontInfo, 10.0f, 60.0f, 0.5f, glm::vec3(1.0f, 1.0f, 0.0f));
+        // 裁剪统计：可见数/总数
+        const int totalBodies = static_cast<int>(planets.size());
+        const int visibleBodies = static_cast<int>(instances.size());
+        if (visibleBodies != shownCullCounts[0] || visibleTrails != shownCullCounts[1] || visibleLabels != shownCullCounts[2]
+            || static_cast<int>(visibleStars) != shownCullCounts[3]) {
+            std::stringstream cullStream;
+            cullStream << "Visible: Bodies " << visibleBodies << "/" << totalBodies
+                       << ", Trails " << visibleTrails << "/" << totalTrails
+                       << ", Labels " << visibleLabels << "/" << totalBodies
+                       << ", Stars " << visibleStars << "/" << starCatalog.Size()
+                       << " (mag " << std::fixed << std::setprecision(1) << magnitudeLimit << ", [/]: limit)";
+            textRenderer.SetText(cullText, cullStream.str(), 10.0f, 150.0f, 0.5f, glm::vec3(1.0f, 1.0f, 0.0f));
+            shownCullCounts[0] = visibleBodies;
+            shownCullCounts[1] = visibleTrails;
+            shownCullCounts[2] = visibleLabels;
+            shownCullCounts[3] = static_cast<int>(visibleStars);
+        }
         
-        std::string nameInfo = "Planet Names: " + std::string(showPlanetNames ? "Shown" : "Hidden") + " (Press Ctrl to toggle)";
-        textRenderer.RenderText(nameInfo, 10.0f, 90.0f, 0.5f, glm::vec3(1.0f, 1.0f, 0.0f));
+        // 模拟与渲染各自的平均耗时（渲染只统计CPU提交，不含等待垂直同步）
+        if (statsFrames > 0 && frameStart - statsStartTime >= 0.5) {
+            double elapsed = frameStart - statsStartTime;
+            achievedWarp = (simulationClock.Time() - statsStartSimulationTime) / elapsed;
+            std::stringstream timingStream;
+            timingStream << std::fixed << std::setprecision(2)
+                         << "Sim: " << simulationCost * 1000.0 / statsFrames << " ms/frame ("
+                         << (simulationClock.Steps() - statsStartSteps) / elapsed << " steps/s, t = "
+                         << std::setprecision(1) << simulationClock.Time() << " s), Render: "
+                         << std::setprecision(2) << renderCost * 1000.0 / statsFrames << " ms/frame, Belt: "
+                         << asteroidBelt.Size() << " bodies, " << beltCost * 1000.0 / statsFrames << " ms/frame (A: toggle)";
+            textRenderer.SetText(timingText, timingStream.str(), 10.0f, 180.0f, 0.5f, glm::vec3(1.0f, 1.0f, 0.0f));
+            
+            // N体模式的核心指标：每秒模拟时间内计算的天体对数
+            std::stringstream nbodyStream;
+            if (nbodyMode) {
+                double interactionRate = simulationCost > 0.0 ? (nbodySystem.Interactions() - statsStartInteractions) / simulationCost : 0.0;
+                nbodyStream << std::fixed << std::setprecision(1) << "N-Body: " << nbodySystem.Size() << " bodies, "
+                            << (barnesHutMode ? "Barnes-Hut" : "Direct") << ", "
+                            << interactionRate / 1e6 << " M interactions/s (" << simulationPool.Size() << " threads, N: toggle, B: solver)";
+            } else {
+                nbodyStream << "N-Body: Off (Press N to toggle)";
+            }
+            textRenderer.SetText(nbodyText, nbodyStream.str(), 10.0f, 210.0f, 0.5f, glm::vec3(1.0f, 1.0f, 0.0f));
+            
+            // 星历模式：当前的儒略日和段缓存命中率
+            std::stringstream ephemerisStream;
+            if (!ephemeris.IsOpen()) {
+                ephemerisStream << "Ephemeris: Not loaded";
+            } else if (ephemerisMode) {
+                double day = ephemerisDay(orbitTimeCurrent);
+                uint64_t lookups = ephemeris.CacheHits() + ephemeris.CacheMisses();
+                ephemerisStream << std::fixed << std::setprecision(1) << "Ephemeris: JD " << day << " (year "
+                                << 2000.0 + (day - J2000_DAY) / DAYS_PER_YEAR << "), segment cache "
+                                << std::setprecision(2) << (lookups > 0 ? 100.0 * ephemeris.CacheHits() / lookups : 100.0)
+                                << "% hits (E: toggle)";
+            } else {
+                ephemerisStream << "Ephemeris: Off (Press E to toggle)";
+            }
+            textRenderer.SetText(ephemerisText, ephemerisStream.str(), 10.0f, 240.0f, 0.5f, glm::vec3(1.0f, 1.0f, 0.0f));
+            
+            // 人造卫星：数量、传播耗时和距最新历元的时间
+            std::stringstream satelliteStream;
+            if (satellites.Size() + deepSpaceSatellites.Size() == 0) {
+                satelliteStream << "Satellites: None loaded";
+            } else {
+                satelliteStream << std::fixed << std::setprecision(2) << "Satellites: " << satellites.Size() << " SGP4 + "
+                                << deepSpaceSatellites.Size() << " deep-space approximate (orange, no SDP4), "
+                                << satelliteCost * 1000.0 / statsFrames
+                                << " ms/frame, epoch +" << std::setprecision(1)
+                                << simulationClock.Time() * SATELLITE_MINUTES_PER_SECOND / 1440.0 << " days ("
+                                << (showSatellites ? "S: hide" : "S: show") << ")";
+            }
+            textRenderer.SetText(satelliteText, satelliteStream.str(), 10.0f, 270.0f, 0.5f, glm::vec3(1.0f, 1.0f, 0.0f));
+            
+            statsStartTime = frameStart;
+            statsStartSteps = simulationClock.Steps();
+            statsStartSimulationTime = simulationClock.Time();
+            statsStartInteractions = nbodySystem.Interactions();
+            simulationCost = 0.0;
+            renderCost = 0.0;
+            beltCost = 0.0;
+            satelliteCost = 0.0;
+            statsFrames = 0;
+        }
         
-        std::string cameraInfo = "Camera Control: Left-click (Rotate), Right-click (Pan), Scroll (Zoom), R (Reset)";
-        textRenderer.RenderText(cameraInfo, 10.0f, 120.0f, 0.5f, glm::vec3(1.0f, 1.0f, 0.0f));
+        // 一次绘制本帧所有文字
+        textRenderer.Flush();
+        renderCost += glfwGetTime() - renderStart;
+        statsFrames++;
         
         // 交换缓冲并检查事件
         glfwSwapBuffers(window);
         glfwPollEvents();
+        
+        // 小天体带性能测试：预热若干帧后计时，测完一种数量就换下一种
+        if (benchBelt) {
+            benchFrame++;
+            if (benchFrame == BELT_BENCH_WARMUP) {
+                benchStart = glfwGetTime();
+                benchBeltCost = 0.0;
+            } else if (benchFrame == BELT_BENCH_WARMUP + BELT_BENCH_FRAMES) {
+                double elapsed = glfwGetTime() - benchStart;
+                std::printf("belt %8zu bodies: %7.1f fps, %6.2f ms/frame (belt update %.2f ms/frame, %u threads)\n",
+                            asteroidBelt.Size(), BELT_BENCH_FRAMES / elapsed, elapsed * 1000.0 / BELT_BENCH_FRAMES,
+                            benchBeltCost * 1000.0 / BELT_BENCH_FRAMES, simulationPool.Size());
+                benchFrame = 0;
+                if (++benchIndex == static_cast<int>(sizeof(BELT_BENCH_COUNTS) / sizeof(BELT_BENCH_COUNTS[0]))) {
+                    glfwSetWindowShouldClose(window, true);
+                } else {
+                    buildBelts(BELT_BENCH_COUNTS[benchIndex]);
+                }
+            }
+        }
     }
     
     // 清理资源
@@ -1000,13 +1965,11 @@ int main() {
     glDeleteBuffers(1, &EBO);
     glDeleteBuffers(1, &texCoordsVBO);
     glDeleteBuffers(1, &normalsVBO);
+    glDeleteBuffers(1, &instanceVBO);
     glDeleteProgram(shaderProgram);
     
     // 释放纹理资源
-    for (const auto& planet : planets) {
-        glDeleteTextures(1, &planet.textureID);
-    }
-    glDeleteTextures(1, &moon.textureID);
+    glDeleteTextures(1, &textureArray);
     
     glfwTerminate();
     return 0;
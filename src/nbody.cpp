@@ -0,0 +1,185 @@
+#include "../include/nbody.h"
+#include "../include/parallel_for.h"
+#include "../include/checksum.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// 并行计算加速度时每块的天体数
+const size_t ACCELERATION_GRAIN = 8 * NBodySystem::LANES;
+
+} // namespace
+
+NBodySystem::NBodySystem(double gravity, double softening)
+    : gravity(gravity), softening(softening), softening2(softening * softening), solver(GravitySolver::Direct), theta(0.5),
+      count(0), accelerationsValid(false), interactions(0)
+{
+}
+
+void NBodySystem::SetSolver(GravitySolver newSolver, double newTheta)
+{
+    solver = newSolver;
+    theta = newTheta;
+    accelerationsValid = false;
+}
+
+size_t NBodySystem::Add(double m, double px, double py, double pz, double pvx, double pvy, double pvz)
+{
+    // 需要时补齐一整组质量为0的空位
+    if (count == x.size()) {
+        const size_t padded = x.size() + LANES;
+        for (std::vector<double>* v : { &x, &y, &z, &vx, &vy, &vz, &ax, &ay, &az, &mass }) {
+            v->resize(padded, 0.0);
+        }
+    }
+
+    x[count] = px;
+    y[count] = py;
+    z[count] = pz;
+    vx[count] = pvx;
+    vy[count] = pvy;
+    vz[count] = pvz;
+    mass[count] = m;
+    accelerationsValid = false;
+    return count++;
+}
+
+void NBodySystem::Assign(size_t newCount, const double* px, const double* py, const double* pz,
+                         const double* pvx, const double* pvy, const double* pvz, const double* pm)
+{
+    // 补齐到LANES的整数倍，补齐部分质量为0
+    const size_t padded = (newCount + LANES - 1) / LANES * LANES;
+    const double* sources[] = { px, py, pz, pvx, pvy, pvz, pm };
+    std::vector<double>* targets[] = { &x, &y, &z, &vx, &vy, &vz, &mass };
+    for (size_t k = 0; k < 7; ++k) {
+        targets[k]->assign(sources[k], sources[k] + newCount);
+        targets[k]->resize(padded, 0.0);
+    }
+    for (std::vector<double>* v : { &ax, &ay, &az }) {
+        v->assign(padded, 0.0);
+    }
+    count = newCount;
+    accelerationsValid = false;
+}
+
+void NBodySystem::Clear()
+{
+    for (std::vector<double>* v : { &x, &y, &z, &vx, &vy, &vz, &ax, &ay, &az, &mass }) {
+        v->clear();
+    }
+    count = 0;
+    accelerationsValid = false;
+}
+
+void NBodySystem::Step(double dt, ThreadPool* pool)
+{
+    if (!accelerationsValid) {
+        ComputeAccelerations(pool);
+    }
+
+    const double halfDt = 0.5 * dt;
+    for (size_t i = 0; i < count; ++i) {
+        vx[i] += ax[i] * halfDt;
+        vy[i] += ay[i] * halfDt;
+        vz[i] += az[i] * halfDt;
+        x[i] += vx[i] * dt;
+        y[i] += vy[i] * dt;
+        z[i] += vz[i] * dt;
+    }
+
+    ComputeAccelerations(pool);
+
+    for (size_t i = 0; i < count; ++i) {
+        vx[i] += ax[i] * halfDt;
+        vy[i] += ay[i] * halfDt;
+        vz[i] += az[i] * halfDt;
+    }
+}
+
+double NBodySystem::Energy() const
+{
+    double kinetic = 0.0;
+    double potential = 0.0;
+    for (size_t i = 0; i < count; ++i) {
+        kinetic += 0.5 * mass[i] * (vx[i] * vx[i] + vy[i] * vy[i] + vz[i] * vz[i]);
+        for (size_t j = i + 1; j < count; ++j) {
+            double dx = x[j] - x[i], dy = y[j] - y[i], dz = z[j] - z[i];
+            potential -= gravity * mass[i] * mass[j] / std::sqrt(dx * dx + dy * dy + dz * dz + softening2);
+        }
+    }
+    return kinetic + potential;
+}
+
+uint64_t NBodySystem::Checksum() const
+{
+    StateChecksum checksum;
+    checksum.Add(count);
+    for (const std::vector<double>* v : { &x, &y, &z, &vx, &vy, &vz }) {
+        checksum.Add(v->data(), count);
+    }
+    return checksum.Value();
+}
+
+void NBodySystem::ComputeAccelerations(ThreadPool* pool)
+{
+    if (solver == GravitySolver::BarnesHut) {
+        tree.Build(x.data(), y.data(), z.data(), mass.data(), count, pool);
+        interactions += tree.Accelerations(theta, gravity, softening2, ax.data(), ay.data(), az.data(), pool);
+        accelerationsValid = true;
+        return;
+    }
+
+    const size_t padded = x.size();
+    if (pool == nullptr) {
+        AccelerationKernel(0, padded);
+    } else {
+        pool->ParallelFor(0, padded, ACCELERATION_GRAIN, [this](size_t begin, size_t end) {
+            AccelerationKernel(begin, end);
+        });
+    }
+    interactions += static_cast<unsigned long long>(count) * count;
+    accelerationsValid = true;
+}
+
+void NBodySystem::AccelerationKernel(size_t begin, size_t end)
+{
+    const size_t n = x.size();
+    const double* __restrict px = x.data();
+    const double* __restrict py = y.data();
+    const double* __restrict pz = z.data();
+    const double* __restrict pm = mass.data();
+
+    for (size_t block = begin; block < end; block += LANES) {
+        double xi[LANES], yi[LANES], zi[LANES];
+        double axi[LANES], ayi[LANES], azi[LANES];
+        for (size_t l = 0; l < LANES; ++l) {
+            xi[l] = px[block + l];
+            yi[l] = py[block + l];
+            zi[l] = pz[block + l];
+            axi[l] = ayi[l] = azi[l] = 0.0;
+        }
+
+        // 对所有j累加，包括自身和补齐的空位：自身距离为0时贡献被置零，空位质量为0
+        for (size_t j = 0; j < n; ++j) {
+            const double xj = px[j], yj = py[j], zj = pz[j], mj = pm[j];
+            for (size_t l = 0; l < LANES; ++l) {
+                double dx = xj - xi[l];
+                double dy = yj - yi[l];
+                double dz = zj - zi[l];
+                double r2 = dx * dx + dy * dy + dz * dz + softening2;
+                double inv = r2 > 0.0 ? 1.0 / std::sqrt(r2) : 0.0;
+                double s = mj * inv * inv * inv;
+                axi[l] += dx * s;
+                ayi[l] += dy * s;
+                azi[l] += dz * s;
+            }
+        }
+
+        for (size_t l = 0; l < LANES; ++l) {
+            ax[block + l] = gravity * axi[l];
+            ay[block + l] = gravity * ayi[l];
+            az[block + l] = gravity * azi[l];
+        }
+    }
+}
@@ -0,0 +1,92 @@
+#include "../include/parallel_for.h"
+
+ThreadPool::ThreadPool(unsigned int threads)
+    : job(nullptr), jobEnd(0), jobGrain(1), next(0), generation(0), busy(0), stopping(false)
+{
+    if (threads == 0) {
+        threads = std::thread::hardware_concurrency();
+    }
+    for (unsigned int i = 1; i < threads; ++i) {
+        workers.emplace_back(&ThreadPool::WorkerLoop, this);
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+}
+
+void ThreadPool::ParallelFor(size_t begin, size_t end, size_t grain, const std::function<void(size_t, size_t)>& fn)
+{
+    if (begin >= end) {
+        return;
+    }
+    if (grain == 0) {
+        grain = 1;
+    }
+
+    // 只有一块或没有工作线程时直接在调用线程执行，块的划分保持不变
+    if (workers.empty() || end - begin <= grain) {
+        for (size_t chunk = begin; chunk < end; chunk += grain) {
+            fn(chunk, chunk + grain < end ? chunk + grain : end);
+        }
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        job = &fn;
+        jobEnd = end;
+        jobGrain = grain;
+        next.store(begin);
+        busy = static_cast<unsigned int>(workers.size());
+        generation++;
+    }
+    wake.notify_all();
+
+    RunChunks();
+
+    std::unique_lock<std::mutex> lock(mutex);
+    done.wait(lock, [this] { return busy == 0; });
+    job = nullptr;
+}
+
+void ThreadPool::WorkerLoop()
+{
+    unsigned int seen = 0;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [&] { return stopping || generation != seen; });
+            if (stopping) {
+                return;
+            }
+            seen = generation;
+        }
+
+        RunChunks();
+
+        std::lock_guard<std::mutex> lock(mutex);
+        if (--busy == 0) {
+            done.notify_one();
+        }
+    }
+}
+
+void ThreadPool::RunChunks()
+{
+    for (;;) {
+        size_t chunk = next.fetch_add(jobGrain);
+        if (chunk >= jobEnd) {
+            return;
+        }
+        (*job)(chunk, chunk + jobGrain < jobEnd ? chunk + jobGrain : jobEnd);
+    }
+}
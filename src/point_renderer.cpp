@@ -0,0 +1,72 @@
+#include "../include/point_renderer.h"
+#include <cstring>
+#include <glm/gtc/type_ptr.hpp>
+
+// 创建着色器程序
+GLuint createShaderProgram(const char* vertexSource, const char* fragmentSource);
+
+PointRenderer::PointRenderer()
+    : capacity(0), offset(0)
+{
+    // 加载并创建着色器程序
+    this->shader = createShaderProgram("shaders/point_vertex.glsl", "shaders/point_fragment.glsl");
+    this->colorLocation = glGetUniformLocation(this->shader, "pointColor");
+    this->sizeLocation = glGetUniformLocation(this->shader, "pointSize");
+
+    // 配置VAO/VBO，缓冲区在第一次绘制时分配
+    glGenVertexArrays(1, &this->VAO);
+    glGenBuffers(1, &this->VBO);
+    glBindVertexArray(this->VAO);
+    glBindBuffer(GL_ARRAY_BUFFER, this->VBO);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindVertexArray(0);
+}
+
+PointRenderer::~PointRenderer()
+{
+    // 清理资源
+    glDeleteVertexArrays(1, &this->VAO);
+    glDeleteBuffers(1, &this->VBO);
+    glDeleteProgram(this->shader);
+}
+
+void PointRenderer::Draw(const glm::vec3* points, size_t count, const glm::vec3& color, float size)
+{
+    if (count == 0) {
+        return;
+    }
+
+    // 剩余空间放不下时孤立旧存储，从头写入；一批都放不下时按两倍增长
+    glBindBuffer(GL_ARRAY_BUFFER, this->VBO);
+    if (this->offset + count > this->capacity) {
+        if (count > this->capacity) {
+            this->capacity = count * 2;
+        }
+        glBufferData(GL_ARRAY_BUFFER, this->capacity * sizeof(glm::vec3), NULL, GL_STREAM_DRAW);
+        this->offset = 0;
+    }
+
+    // 写入的范围之前没有被任何已提交的绘制使用，不需要同步
+    const GLintptr start = this->offset * sizeof(glm::vec3);
+    const GLsizeiptr bytes = count * sizeof(glm::vec3);
+    void* mapped = glMapBufferRange(GL_ARRAY_BUFFER, start, bytes,
+                                    GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+    if (mapped != NULL) {
+        std::memcpy(mapped, points, bytes);
+        glUnmapBuffer(GL_ARRAY_BUFFER);
+    } else {
+        glBufferSubData(GL_ARRAY_BUFFER, start, bytes, points);
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    glUseProgram(this->shader);
+    glUniform3fv(this->colorLocation, 1, glm::value_ptr(color));
+    glUniform1f(this->sizeLocation, size);
+
+    glBindVertexArray(this->VAO);
+    glDrawArrays(GL_POINTS, static_cast<GLint>(this->offset), static_cast<GLsizei>(count));
+    glBindVertexArray(0);
+    this->offset += count;
+}
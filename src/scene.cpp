@@ -0,0 +1,386 @@
+#include "../include/scene.h"
+#include <cctype>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <unordered_map>
+#include <sys/stat.h>
+
+namespace {
+
+const char SCENE_MAGIC[8] = { 'S', 'O', 'L', 'A', 'R', 'S', 'C', 'N' };
+const uint32_t SCENE_BYTE_ORDER = 0x01020304;
+
+// 文件头和记录都没有填充字节，布局与编译器无关
+static_assert(sizeof(SceneHeader) == 64, "SceneHeader layout changed, bump SCENE_VERSION");
+static_assert(sizeof(SceneBody) == 184, "SceneBody layout changed, bump SCENE_VERSION");
+
+size_t alignUp(size_t offset)
+{
+    return (offset + SCENE_ALIGNMENT - 1) / SCENE_ALIGNMENT * SCENE_ALIGNMENT;
+}
+
+// 源文件的大小和修改时间（纳秒），文件不存在时返回false
+bool sourceStamp(const char* path, uint64_t& size, int64_t& modified)
+{
+    struct stat info;
+    if (stat(path, &info) != 0) {
+        return false;
+    }
+    size = static_cast<uint64_t>(info.st_size);
+#ifdef __APPLE__
+    modified = static_cast<int64_t>(info.st_mtimespec.tv_sec) * 1000000000 + info.st_mtimespec.tv_nsec;
+#else
+    modified = static_cast<int64_t>(info.st_mtim.tv_sec) * 1000000000 + info.st_mtim.tv_nsec;
+#endif
+    return true;
+}
+
+std::string trim(const std::string& text)
+{
+    size_t begin = 0, end = text.size();
+    while (begin < end && std::isspace(static_cast<unsigned char>(text[begin]))) {
+        ++begin;
+    }
+    while (end > begin && std::isspace(static_cast<unsigned char>(text[end - 1]))) {
+        --end;
+    }
+    return text.substr(begin, end - begin);
+}
+
+// 整个字符串是一个有限的数时返回true（不接受nan和inf）
+bool parseNumber(const std::string& text, float& value)
+{
+    const char* begin = text.c_str();
+    char* end = nullptr;
+    double parsed = std::strtod(begin, &end);
+    if (end == begin || *end != '\0' || !std::isfinite(parsed)) {
+        return false;
+    }
+    value = static_cast<float>(parsed);
+    return true;
+}
+
+// 沿中心天体向上走超过count步的天体处在环中，返回第一个这样的天体，没有时返回-1
+int findParentCycle(const SceneBody* bodies, size_t count)
+{
+    for (size_t i = 0; i < count; ++i) {
+        size_t depth = 0;
+        for (int p = bodies[i].parent; p >= 0; p = bodies[p].parent) {
+            if (++depth > count) {
+                return static_cast<int>(i);
+            }
+        }
+    }
+    return -1;
+}
+
+// 数值字段的键和在SceneBody中的位置
+struct NumberField {
+    const char* key;
+    float SceneBody::*member;
+};
+
+const NumberField NUMBER_FIELDS[] = {
+    { "radius", &SceneBody::radius },
+    { "distance", &SceneBody::distance },
+    { "eccentricity", &SceneBody::eccentricity },
+    { "inclination", &SceneBody::inclination },
+    { "ascendingNode", &SceneBody::ascendingNode },
+    { "argumentOfPeriapsis", &SceneBody::argumentOfPeriapsis },
+    { "meanAnomaly", &SceneBody::meanAnomaly },
+    { "mass", &SceneBody::mass },
+    { "orbitSpeed", &SceneBody::orbitSpeed },
+    { "rotationSpeed", &SceneBody::rotationSpeed },
+    { "tilt", &SceneBody::tilt },
+};
+
+// 检查解析结果和映射的缓存都必须满足的约定：每个天体都有纹理，数值有限且在KeplerBatch和N体计算能接受的范围内
+// （0 <= 偏心率 < 1，半径为正，非根天体的距离为正，质量非负），层级没有环，恰好有一个根，根的质量为正
+// （N体模式下太阳的速度要除以它的质量）。出错时返回false，给出原因和出错的天体（-1表示整个场景）
+bool checkBodies(const SceneBody* bodies, size_t count, std::string& message, int& body)
+{
+    int root = -1, roots = 0;
+    for (size_t i = 0; i < count; ++i) {
+        body = static_cast<int>(i);
+        const std::string name = bodies[i].name;
+        if (bodies[i].texture[0] == '\0') {
+            message = "body '" + name + "' has no texture";
+            return false;
+        }
+        for (const NumberField& field : NUMBER_FIELDS) {
+            if (!std::isfinite(bodies[i].*(field.member))) {
+                message = "body '" + name + "' has a non-finite " + field.key;
+                return false;
+            }
+        }
+        if (!(bodies[i].eccentricity >= 0.0f && bodies[i].eccentricity < 1.0f)) {
+            message = "body '" + name + "' needs 0 <= eccentricity < 1";
+            return false;
+        }
+        if (!(bodies[i].radius > 0.0f)) {
+            message = "body '" + name + "' needs a positive radius";
+            return false;
+        }
+        if (bodies[i].parent >= 0 && !(bodies[i].distance > 0.0f)) {
+            message = "body '" + name + "' needs a positive distance";
+            return false;
+        }
+        if (!(bodies[i].mass >= 0.0f)) {
+            message = "body '" + name + "' has a negative mass";
+            return false;
+        }
+        if (bodies[i].parent < 0) {
+            root = body;
+            roots++;
+        }
+    }
+    body = findParentCycle(bodies, count);
+    if (body >= 0) {
+        message = "body '" + std::string(bodies[body].name) + "' is part of a parent cycle";
+        return false;
+    }
+    if (roots != 1) {
+        message = "the scene needs exactly one root body (found " + std::to_string(roots) + ")";
+        return false;
+    }
+    body = root;
+    if (!(bodies[root].mass > 0.0f)) {
+        message = "root body '" + std::string(bodies[root].name) + "' needs a positive mass";
+        return false;
+    }
+    return true;
+}
+
+} // namespace
+
+bool ParseSceneText(const char* path, std::vector<SceneBody>& bodies, std::string& error)
+{
+    std::ifstream file(path);
+    if (!file) {
+        error = std::string("cannot open ") + path;
+        return false;
+    }
+
+    // 先按文本记下各天体的中心天体名称，全部读完后再换成编号，文件中的顺序不限
+    std::vector<std::string> parentNames;
+    std::vector<int> bodyLines;
+    std::unordered_map<std::string, int32_t> indices;
+    std::string line;
+    int lineNumber = 0;
+    bodies.clear();
+    auto fail = [&](const std::string& message) {
+        error = std::string(path) + ":" + std::to_string(lineNumber) + ": " + message;
+        return false;
+    };
+
+    while (std::getline(file, line)) {
+        ++lineNumber;
+        line = trim(line.substr(0, line.find('#')));
+        if (line.empty()) {
+            continue;
+        }
+        size_t space = line.find_first_of(" \t");
+        const std::string key = line.substr(0, space);
+        const std::string value = space == std::string::npos ? std::string() : trim(line.substr(space));
+
+        if (key == "body") {
+            if (value.empty() || value.size() >= SCENE_NAME_LENGTH) {
+                return fail("body name must be 1-" + std::to_string(SCENE_NAME_LENGTH - 1) + " characters");
+            }
+            if (!indices.emplace(value, static_cast<int32_t>(bodies.size())).second) {
+                return fail("duplicate body '" + value + "'");
+            }
+            SceneBody body = {};
+            std::strncpy(body.name, value.c_str(), SCENE_NAME_LENGTH - 1);
+            body.parent = -1;
+            body.flags = SCENE_BODY_TRAIL;
+            bodies.push_back(body);
+            parentNames.emplace_back();
+            bodyLines.push_back(lineNumber);
+            continue;
+        }
+        if (bodies.empty()) {
+            return fail("'" + key + "' before the first body");
+        }
+        SceneBody& body = bodies.back();
+        if (value.empty()) {
+            return fail("missing value for '" + key + "'");
+        }
+
+        if (key == "parent") {
+            parentNames.back() = value;
+        } else if (key == "texture") {
+            if (value.size() >= SCENE_TEXTURE_LENGTH) {
+                return fail("texture path longer than " + std::to_string(SCENE_TEXTURE_LENGTH - 1) + " characters");
+            }
+            std::strncpy(body.texture, value.c_str(), SCENE_TEXTURE_LENGTH - 1);
+        } else if (key == "emissive" || key == "trail") {
+            float flag;
+            if (!parseNumber(value, flag)) {
+                return fail("'" + key + "' expects 0 or 1");
+            }
+            const uint32_t bit = key == "emissive" ? SCENE_BODY_EMISSIVE : SCENE_BODY_TRAIL;
+            body.flags = flag != 0.0f ? (body.flags | bit) : (body.flags & ~bit);
+        } else {
+            const NumberField* field = nullptr;
+            for (const NumberField& candidate : NUMBER_FIELDS) {
+                if (key == candidate.key) {
+                    field = &candidate;
+                }
+            }
+            if (field == nullptr) {
+                return fail("unknown key '" + key + "'");
+            }
+            if (!parseNumber(value, body.*(field->member))) {
+                return fail("'" + key + "' expects a number, got '" + value + "'");
+            }
+        }
+    }
+
+    // 换算中心天体编号，再检查与缓存相同的约定
+    for (size_t i = 0; i < bodies.size(); ++i) {
+        lineNumber = bodyLines[i];
+        if (parentNames[i].empty()) {
+            continue;
+        }
+        auto found = indices.find(parentNames[i]);
+        if (found == indices.end() || found->second == static_cast<int32_t>(i)) {
+            return fail("body '" + std::string(bodies[i].name) + "' has an invalid parent '" + parentNames[i] + "'");
+        }
+        bodies[i].parent = found->second;
+    }
+    std::string message;
+    int body = -1;
+    if (!checkBodies(bodies.data(), bodies.size(), message, body)) {
+        if (body < 0) {
+            error = std::string(path) + ": " + message;
+            return false;
+        }
+        lineNumber = bodyLines[body];
+        return fail(message);
+    }
+    return true;
+}
+
+bool WriteSceneCache(const char* path, const std::vector<SceneBody>& bodies, uint64_t sourceSize, int64_t sourceModified)
+{
+    SceneHeader header = {};
+    std::memcpy(header.magic, SCENE_MAGIC, sizeof(header.magic));
+    header.version = SCENE_VERSION;
+    header.byteOrder = SCENE_BYTE_ORDER;
+    header.sourceSize = sourceSize;
+    header.sourceModified = sourceModified;
+    header.bodyCount = bodies.size();
+    header.bodiesOffset = alignUp(sizeof(SceneHeader));
+    header.fileSize = header.bodiesOffset + bodies.size() * sizeof(SceneBody);
+    header.recordSize = sizeof(SceneBody);
+
+    // 先写临时文件再改名，同时启动的另一个进程不会读到写了一半的缓存
+    const std::string temporary = std::string(path) + ".tmp";
+    FILE* file = std::fopen(temporary.c_str(), "wb");
+    if (file == nullptr) {
+        return false;
+    }
+    static const char zeros[SCENE_ALIGNMENT] = {};
+    const size_t padding = header.bodiesOffset - sizeof(header);
+    bool ok = std::fwrite(&header, sizeof(header), 1, file) == 1
+           && std::fwrite(zeros, 1, padding, file) == padding
+           && (bodies.empty() || std::fwrite(bodies.data(), sizeof(SceneBody), bodies.size(), file) == bodies.size());
+    ok = (std::fclose(file) == 0) && ok;
+    if (!ok || std::rename(temporary.c_str(), path) != 0) {
+        std::remove(temporary.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool Scene::OpenCache(const std::string& path)
+{
+    header = nullptr;
+    if (!file.Open(path.c_str()) || file.Size() < sizeof(SceneHeader)) {
+        return false;
+    }
+
+    const SceneHeader* h = reinterpret_cast<const SceneHeader*>(file.Data());
+    if (std::memcmp(h->magic, SCENE_MAGIC, sizeof(h->magic)) != 0 || h->version != SCENE_VERSION
+        || h->byteOrder != SCENE_BYTE_ORDER || h->fileSize != file.Size() || h->recordSize != sizeof(SceneBody)) {
+        file.Close();
+        return false;
+    }
+
+    // 天体表必须对齐并且完整地落在文件内：先确认起点在文件内，再与剩余字节数比较，偏移再大也不会回绕
+    if (h->bodiesOffset % SCENE_ALIGNMENT != 0 || h->bodiesOffset > file.Size() || h->bodyCount > file.Size()
+        || h->bodyCount * sizeof(SceneBody) > file.Size() - h->bodiesOffset) {
+        file.Close();
+        return false;
+    }
+
+    // 记录直接来自映射内存，名称和中心天体编号不可信时拒绝整个缓存
+    const SceneBody* records = reinterpret_cast<const SceneBody*>(file.Data() + h->bodiesOffset);
+    for (uint64_t i = 0; i < h->bodyCount; ++i) {
+        if (records[i].name[SCENE_NAME_LENGTH - 1] != '\0' || records[i].texture[SCENE_TEXTURE_LENGTH - 1] != '\0'
+            || records[i].parent < -1 || records[i].parent >= static_cast<int64_t>(h->bodyCount)) {
+            file.Close();
+            return false;
+        }
+    }
+    std::string message;
+    int body = -1;
+    if (!checkBodies(records, h->bodyCount, message, body)) {
+        file.Close();
+        return false;
+    }
+
+    header = h;
+    return true;
+}
+
+bool Scene::Load(const char* sourcePath, std::string& error)
+{
+    header = nullptr;
+    parsed.clear();
+    compiled = false;
+    const std::string cachePath = std::string(sourcePath) + ".cache";
+
+    // 源文件不存在时只能使用缓存（例如只分发了编译好的场景）
+    uint64_t sourceSize = 0;
+    int64_t sourceModified = 0;
+    if (!sourceStamp(sourcePath, sourceSize, sourceModified)) {
+        if (OpenCache(cachePath)) {
+            return true;
+        }
+        error = std::string("cannot open ") + sourcePath;
+        return false;
+    }
+
+    if (OpenCache(cachePath) && header->sourceSize == sourceSize && header->sourceModified == sourceModified) {
+        return true;
+    }
+    header = nullptr;
+    file.Close();
+
+    // 缓存不存在或已过期：解析源文件并写出缓存，再映射新缓存，与之后的启动走同一条路径
+    std::vector<SceneBody> bodies;
+    if (!ParseSceneText(sourcePath, bodies, error)) {
+        return false;
+    }
+    compiled = true;
+    if (WriteSceneCache(cachePath.c_str(), bodies, sourceSize, sourceModified) && OpenCache(cachePath)) {
+        return true;
+    }
+    parsed = std::move(bodies);
+    return true;
+}
+
+size_t Scene::Size() const
+{
+    return header != nullptr ? static_cast<size_t>(header->bodyCount) : parsed.size();
+}
+
+const SceneBody* Scene::Bodies() const
+{
+    return header != nullptr ? reinterpret_cast<const SceneBody*>(file.Data() + header->bodiesOffset) : parsed.data();
+}
@@ -0,0 +1,499 @@
+#include "../include/sgp4.h"
+#include "../include/parallel_for.h"
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+
+namespace {
+
+// 并行传播时每块的卫星数，是8通道的整数倍
+const size_t PROPAGATE_GRAIN = 1024;
+
+const double PI = 3.14159265358979323846;
+const double TWO_PI = 6.283185307179586;
+const double INV_TWO_PI = 0.15915494309189535;
+const double TWO_OVER_PI = 0.6366197723675814;
+const double DEG = PI / 180.0;
+const double MINUTES_PER_DAY = 1440.0;
+
+// WGS-72常数（SGP4按它们拟合，TLE也按它们发布）
+const double EARTH_RADIUS = 6378.135;           // km
+const double EARTH_MU = 398600.8;               // km^3/s^2
+const double XKE = 60.0 / std::sqrt(EARTH_RADIUS * EARTH_RADIUS * EARTH_RADIUS / EARTH_MU);
+const double J2 = 0.001082616;
+const double J3 = -0.00000253881;
+const double J4 = -0.00000165597;
+const double J3OJ2 = J3 / J2;
+const double X2O3 = 2.0 / 3.0;
+
+// 周期不短于225分钟的卫星属于深空模型
+const double DEEP_SPACE_PERIOD = 225.0;
+
+// fdlibm的Cody-Waite拆分π/2，前两项只有33位有效数字，与|k| < 2^20的整数相乘没有舍入误差
+const double PIO2_1 = 1.57079632673412561417e+00;
+const double PIO2_2 = 6.07710050630396597660e-11;
+const double PIO2_3 = 2.02226624871116645580e-21;
+
+// 加上再减去1.5 * 2^52，按当前舍入模式取整到最近的整数，不需要分支或库函数
+inline double roundNearest(double v)
+{
+    const double magic = 6755399441055744.0;
+    return (v + magic) - magic;
+}
+
+// 把角度归约到[-π, π]
+inline double wrapAngle(double angle)
+{
+    return angle - TWO_PI * roundNearest(angle * INV_TWO_PI);
+}
+
+// 无分支的双精度sin/cos，系数取自fdlibm的__kernel_sin/__kernel_cos（|r| <= π/4）
+// |x|不超过约10^6弧度时误差在1-2 ulp
+inline void sinCos(double v, double& s, double& c)
+{
+    double k = roundNearest(v * TWO_OVER_PI);
+    double r = ((v - k * PIO2_1) - k * PIO2_2) - k * PIO2_3;
+    int quadrant = static_cast<int>(k) & 3;
+
+    double r2 = r * r;
+    double sr = r + r * r2 * (-1.66666666666666324348e-01 + r2 * (8.33333333332248946124e-03
+                    + r2 * (-1.98412698298579493134e-04 + r2 * (2.75573137070700676789e-06
+                    + r2 * (-2.50507602534068634195e-08 + r2 * 1.58969099521155010221e-10)))));
+    double cr = 1.0 - 0.5 * r2 + r2 * r2 * (4.16666666666666019037e-02 + r2 * (-1.38888888888741095749e-03
+                    + r2 * (2.48015872894767294178e-05 + r2 * (-2.75573143513906633035e-07
+                    + r2 * (2.08757232129817482790e-09 + r2 * -1.13596475577881948265e-11)))));
+
+    // 按象限交换和取反
+    double sinValue = (quadrant & 1) ? cr : sr;
+    double cosValue = (quadrant & 1) ? sr : cr;
+    s = (quadrant & 2) ? -sinValue : sinValue;
+    c = ((quadrant + 1) & 2) ? -cosValue : cosValue;
+}
+
+// line[start, start + length)中的数字，前后可以有空格，整段都是空格或无法解析时返回false
+bool parseField(const std::string& line, size_t start, size_t length, double& value)
+{
+    const std::string field = line.substr(start, length);
+    const char* begin = field.c_str();
+    char* end = nullptr;
+    value = std::strtod(begin, &end);
+    if (end == begin) {
+        return false;
+    }
+    for (; *end != '\0'; ++end) {
+        if (!std::isspace(static_cast<unsigned char>(*end))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// TLE中省略小数点的指数记法，例如" 28098-4"表示0.28098e-4
+bool parseExponent(const std::string& line, size_t start, double& value)
+{
+    double mantissa, exponent;
+    if (!parseField(line, start + 1, 5, mantissa) || !parseField(line, start + 6, 2, exponent)) {
+        return false;
+    }
+    value = mantissa * 1e-5 * std::pow(10.0, exponent);
+    if (line[start] == '-') {
+        value = -value;
+    }
+    return true;
+}
+
+// 卫星编号，超过99999时首位是字母（Alpha-5，跳过I和O）
+int parseCatalogNumber(const std::string& line)
+{
+    const char first = static_cast<char>(std::toupper(static_cast<unsigned char>(line[2])));
+    if (first >= 'A' && first <= 'Z') {
+        int digit = first - 'A' + 10;
+        digit -= first > 'I' ? 1 : 0;
+        digit -= first > 'O' ? 1 : 0;
+        return digit * 10000 + std::atoi(line.substr(3, 4).c_str());
+    }
+    return std::atoi(line.substr(2, 5).c_str());
+}
+
+// 第year年1月0日0时的儒略日
+double yearStartDay(int year)
+{
+    return 367.0 * year - std::floor(7.0 * year / 4.0) + 30.0 + 1721013.5;
+}
+
+// 一行是否是TLE的第number行（行号后跟空格，长度够所有字段）
+bool isElementLine(const std::string& line, char number)
+{
+    return line.size() >= 63 && line[0] == number && line[1] == ' ';
+}
+
+// 传播核心用到的各个分量数组（命名与参考实现一致）
+struct Sgp4Arrays {
+    const double *epoch, *mo, *mdot, *argpo, *argpdot, *nodeo, *nodedot, *nodecf;
+    const double *cc1, *cc4, *cc5, *t2cof, *t3cof, *t4cof, *t5cof, *d2, *d3, *d4;
+    const double *omgcof, *xmcof, *eta, *delmo, *sinmao;
+    const double *ecco, *inclo, *sinio, *cosio, *ao, *no;
+    const double *aycof, *xlcof, *con41, *x1mth2, *x7thm1;
+    double *x, *y, *z;
+};
+
+// 传播核心：每颗卫星执行同样的一串算术，没有分支；
+// 各数组互不重叠（由ivdep告知编译器），整个循环可以向量化
+void propagateRange(const Sgp4Arrays& a, double day, size_t begin, size_t end)
+{
+    const double *epoch = a.epoch, *mo = a.mo, *mdot = a.mdot, *argpo = a.argpo, *argpdot = a.argpdot;
+    const double *nodeo = a.nodeo, *nodedot = a.nodedot, *nodecf = a.nodecf;
+    const double *cc1 = a.cc1, *cc4 = a.cc4, *cc5 = a.cc5;
+    const double *t2cof = a.t2cof, *t3cof = a.t3cof, *t4cof = a.t4cof, *t5cof = a.t5cof;
+    const double *d2 = a.d2, *d3 = a.d3, *d4 = a.d4;
+    const double *omgcof = a.omgcof, *xmcof = a.xmcof, *eta = a.eta, *delmo = a.delmo, *sinmao = a.sinmao;
+    const double *ecco = a.ecco, *inclo = a.inclo, *sinio = a.sinio, *cosio = a.cosio, *ao = a.ao, *no = a.no;
+    const double *aycof = a.aycof, *xlcof = a.xlcof, *con41 = a.con41, *x1mth2 = a.x1mth2, *x7thm1 = a.x7thm1;
+    double *outX = a.x, *outY = a.y, *outZ = a.z;
+
+#pragma GCC ivdep
+    for (size_t i = begin; i < end; ++i) {
+        // 距历元的分钟数
+        const double t = (day - epoch[i]) * MINUTES_PER_DAY;
+        const double t2 = t * t;
+        const double t3 = t2 * t;
+        const double t4 = t3 * t;
+
+        // 引力和大气阻力的长期项；简化模型的卫星omgcof、xmcof、cc5、d2-d4、t3cof-t5cof都为零
+        const double xmdf = mo[i] + mdot[i] * t;
+        const double argpdf = argpo[i] + argpdot[i] * t;
+        const double nodedf = nodeo[i] + nodedot[i] * t;
+        double sinM, cosM;
+        sinCos(xmdf, sinM, cosM);
+        const double delmtemp = 1.0 + eta[i] * cosM;
+        const double delm = xmcof[i] * (delmtemp * delmtemp * delmtemp - delmo[i]);
+        const double delomg = omgcof[i] * t + delm;
+        double mm = xmdf + delomg;
+        const double argpm = wrapAngle(argpdf - delomg);
+        const double nodem = wrapAngle(nodedf + nodecf[i] * t2);
+        sinCos(mm, sinM, cosM);
+        const double tempa = 1.0 - cc1[i] * t - d2[i] * t2 - d3[i] * t3 - d4[i] * t4;
+        const double tempe = cc4[i] * t + cc5[i] * (sinM - sinmao[i]);
+        const double templ = t2cof[i] * t2 + t3cof[i] * t3 + t4 * (t4cof[i] + t * t5cof[i]);
+
+        const double am = ao[i] * tempa * tempa;
+        double em = ecco[i] - tempe;
+        bool valid = (em < 1.0) & (em >= -0.001);
+        em = em < 1.0e-6 ? 1.0e-6 : em;
+        mm += no[i] * templ;
+
+        // 长周期项
+        double sinArgp, cosArgp;
+        sinCos(argpm, sinArgp, cosArgp);
+        const double axnl = em * cosArgp;
+        double temp = 1.0 / (am * (1.0 - em * em));
+        const double aynl = em * sinArgp + temp * aycof[i];
+        const double u = wrapAngle(mm + argpm + temp * xlcof[i] * axnl);
+
+        // 解开普勒方程，每步最多前进0.95弧度；与参考实现一样使用最后一步之前的sin/cos
+        // 迭代完全展开，外层循环才能向量化
+        double eo1 = u;
+        double sineo1 = 0.0, coseo1 = 1.0;
+#pragma GCC unroll 16
+        for (int iteration = 0; iteration < Sgp4Batch::KEPLER_ITERATIONS; ++iteration) {
+            sinCos(eo1, sineo1, coseo1);
+            double step = (u - aynl * coseo1 + axnl * sineo1 - eo1) / (1.0 - coseo1 * axnl - sineo1 * aynl);
+            step = step > 0.95 ? 0.95 : step;
+            step = step < -0.95 ? -0.95 : step;
+            eo1 += step;
+        }
+
+        // 短周期项
+        const double ecose = axnl * coseo1 + aynl * sineo1;
+        const double esine = axnl * sineo1 - aynl * coseo1;
+        const double el2 = axnl * axnl + aynl * aynl;
+        const double pl = am * (1.0 - el2);
+        valid = valid & (pl > 0.0);
+        const double rl = am * (1.0 - ecose);
+        const double betal = std::sqrt(1.0 - el2);
+        temp = esine / (1.0 + betal);
+        const double sinu = am / rl * (sineo1 - aynl - axnl * temp);
+        const double cosu = am / rl * (coseo1 - axnl + aynl * temp);
+        const double sin2u = (cosu + cosu) * sinu;
+        const double cos2u = 1.0 - 2.0 * sinu * sinu;
+        temp = 1.0 / pl;
+        const double temp1 = 0.5 * J2 * temp;
+        const double temp2 = temp1 * temp;
+
+        const double mrt = rl * (1.0 - 1.5 * temp2 * betal * con41[i]) + 0.5 * temp1 * x1mth2[i] * cos2u;
+        const double xnode = nodem + 1.5 * temp2 * cosio[i] * sin2u;
+        const double xinc = inclo[i] + 1.5 * temp2 * cosio[i] * sinio[i] * cos2u;
+        valid = valid & (mrt >= 1.0);
+
+        // 纬度幅角的短周期修正很小，由u的sin/cos直接转过去，不需要atan2
+        double sinDu, cosDu;
+        sinCos(-0.25 * temp2 * x7thm1[i] * sin2u, sinDu, cosDu);
+        const double sinsu = sinu * cosDu + cosu * sinDu;
+        const double cossu = cosu * cosDu - sinu * sinDu;
+        double snod, cnod, sini, cosi;
+        sinCos(xnode, snod, cnod);
+        sinCos(xinc, sini, cosi);
+        const double xmx = -snod * cosi;
+        const double xmy = cnod * cosi;
+        const double r = mrt * EARTH_RADIUS;
+        const double px = r * (xmx * sinsu + cnod * cossu);
+        const double py = r * (xmy * sinsu + snod * cossu);
+        const double pz = r * (sini * sinsu);
+        outX[i] = valid ? px : 0.0;
+        outY[i] = valid ? py : 0.0;
+        outZ[i] = valid ? pz : 0.0;
+    }
+}
+
+// 去掉TLE平均运动中的Kozai平均，得到Brouwer平均运动（弧度/分钟）
+double brouwerMeanMotion(const TwoLineElements& elements)
+{
+    const double omeosq = 1.0 - elements.eccentricity * elements.eccentricity;
+    const double cosio = std::cos(elements.inclination);
+    const double ak = std::pow(XKE / elements.meanMotion, X2O3);
+    const double d1 = 0.75 * J2 * (3.0 * cosio * cosio - 1.0) / (std::sqrt(omeosq) * omeosq);
+    double del = d1 / (ak * ak);
+    const double adel = ak * (1.0 - del * del - del * (1.0 / 3.0 + 134.0 * del * del / 81.0));
+    del = d1 / (adel * adel);
+    return elements.meanMotion / (1.0 + del);
+}
+
+} // namespace
+
+bool ParseTwoLineElements(const std::string& line1, const std::string& line2, TwoLineElements& elements)
+{
+    if (!isElementLine(line1, '1') || !isElementLine(line2, '2') || line1.size() < 61) {
+        return false;
+    }
+
+    double year, dayOfYear, inclination, node, eccentricity, perigee, anomaly, motion;
+    if (!parseField(line1, 18, 2, year) || !parseField(line1, 20, 12, dayOfYear) || !parseExponent(line1, 53, elements.bstar)
+        || !parseField(line2, 8, 8, inclination) || !parseField(line2, 17, 8, node)
+        || !parseField(line2, 26, 7, eccentricity) || !parseField(line2, 34, 8, perigee)
+        || !parseField(line2, 43, 8, anomaly) || !parseField(line2, 52, 11, motion)) {
+        return false;
+    }
+
+    // 两位年份：57-99为20世纪，00-56为21世纪
+    const int fullYear = year < 57.0 ? 2000 + static_cast<int>(year) : 1900 + static_cast<int>(year);
+    elements.catalogNumber = parseCatalogNumber(line1);
+    elements.epoch = yearStartDay(fullYear) + dayOfYear;
+    elements.inclination = inclination * DEG;
+    elements.ascendingNode = node * DEG;
+    elements.eccentricity = eccentricity * 1e-7;
+    elements.argumentOfPerigee = perigee * DEG;
+    elements.meanAnomaly = anomaly * DEG;
+    elements.meanMotion = motion * TWO_PI / MINUTES_PER_DAY;
+    return true;
+}
+
+bool LoadTwoLineElements(const char* path, std::vector<TwoLineElements>& elements)
+{
+    std::ifstream file(path);
+    if (!file) {
+        return false;
+    }
+    std::vector<std::string> lines;
+    std::string line;
+    while (std::getline(file, line)) {
+        while (!line.empty() && std::isspace(static_cast<unsigned char>(line.back()))) {
+            line.pop_back();
+        }
+        lines.push_back(line);
+    }
+
+    for (size_t i = 0; i + 1 < lines.size(); ++i) {
+        TwoLineElements tle;
+        if (!ParseTwoLineElements(lines[i], lines[i + 1], tle)) {
+            continue;
+        }
+        // 前一行不是根数行时是名称行；3LE格式的名称行以"0 "开头
+        if (i > 0 && !isElementLine(lines[i - 1], '1') && !isElementLine(lines[i - 1], '2')) {
+            tle.name = lines[i - 1].compare(0, 2, "0 ") == 0 ? lines[i - 1].substr(2) : lines[i - 1];
+        }
+        elements.push_back(tle);
+        ++i;
+    }
+    return true;
+}
+
+bool Sgp4Batch::IsDeepSpace(const TwoLineElements& elements)
+{
+    if (!(elements.eccentricity >= 0.0 && elements.eccentricity < 1.0) || !(elements.meanMotion > 0.0)) {
+        return false;
+    }
+    return TWO_PI / brouwerMeanMotion(elements) >= DEEP_SPACE_PERIOD;
+}
+
+bool Sgp4Batch::Add(const TwoLineElements& elements)
+{
+    const double ecc = elements.eccentricity;
+    const double inc = elements.inclination;
+    const double bstar = elements.bstar;
+    if (!(ecc >= 0.0 && ecc < 1.0) || !(elements.meanMotion > 0.0)) {
+        return false;
+    }
+
+    // 没有SDP4项时深空卫星不是SGP4的结果，只有近似批次接受
+    const double no = brouwerMeanMotion(elements);
+    const bool deep = TWO_PI / no >= DEEP_SPACE_PERIOD;
+    if (deep && !approximate) {
+        return false;
+    }
+
+    const double eccsq = ecc * ecc;
+    const double omeosq = 1.0 - eccsq;
+    const double rteosq = std::sqrt(omeosq);
+    const double cosio = std::cos(inc);
+    const double cosio2 = cosio * cosio;
+    const double sinio = std::sin(inc);
+
+    const double ao = std::pow(XKE / no, X2O3);
+    const double po = ao * omeosq;
+    const double con42 = 1.0 - 5.0 * cosio2;
+    const double con41Value = -con42 - cosio2 - cosio2;
+    const double posq = po * po;
+    const double rp = ao * (1.0 - ecc);
+    if (rp < 1.0) {
+        return false;
+    }
+
+    // 近地点低于220 km（以及近似传播的深空卫星）使用简化模型；近地点低于156 km时调整大气模型的参数
+    const bool simple = deep || rp < 220.0 / EARTH_RADIUS + 1.0;
+    const double perigeeHeight = (rp - 1.0) * EARTH_RADIUS;
+    double sfour = 78.0 / EARTH_RADIUS + 1.0;
+    double qzms24 = std::pow((120.0 - 78.0) / EARTH_RADIUS, 4.0);
+    if (perigeeHeight < 156.0) {
+        sfour = perigeeHeight < 98.0 ? 20.0 : perigeeHeight - 78.0;
+        qzms24 = std::pow((120.0 - sfour) / EARTH_RADIUS, 4.0);
+        sfour = sfour / EARTH_RADIUS + 1.0;
+    }
+
+    const double pinvsq = 1.0 / posq;
+    const double tsi = 1.0 / (ao - sfour);
+    const double etaValue = ao * ecc * tsi;
+    const double etasq = etaValue * etaValue;
+    const double eeta = ecc * etaValue;
+    const double psisq = std::fabs(1.0 - etasq);
+    const double coef = qzms24 * std::pow(tsi, 4.0);
+    const double coef1 = coef / std::pow(psisq, 3.5);
+    const double cc2 = coef1 * no * (ao * (1.0 + 1.5 * etasq + eeta * (4.0 + etasq))
+                       + 0.375 * J2 * tsi / psisq * con41Value * (8.0 + 3.0 * etasq * (8.0 + etasq)));
+    const double c1 = bstar * cc2;
+    const double cc3 = ecc > 1.0e-4 ? -2.0 * coef * tsi * J3OJ2 * no * sinio / ecc : 0.0;
+    const double x1mth2Value = 1.0 - cosio2;
+    const double c4 = 2.0 * no * coef1 * ao * omeosq
+                      * (etaValue * (2.0 + 0.5 * etasq) + ecc * (0.5 + 2.0 * etasq)
+                         - J2 * tsi / (ao * psisq) * (-3.0 * con41Value * (1.0 - 2.0 * eeta + etasq * (1.5 - 0.5 * eeta))
+                         + 0.75 * x1mth2Value * (2.0 * etasq - eeta * (1.0 + etasq)) * std::cos(2.0 * elements.argumentOfPerigee)));
+    const double c5 = 2.0 * coef1 * ao * omeosq * (1.0 + 2.75 * (etasq + eeta) + eeta * etasq);
+
+    const double cosio4 = cosio2 * cosio2;
+    const double temp1 = 1.5 * J2 * pinvsq * no;
+    const double temp2 = 0.5 * temp1 * J2 * pinvsq;
+    const double temp3 = -0.46875 * J4 * pinvsq * pinvsq * no;
+    const double xhdot1 = -temp1 * cosio;
+
+    epoch.push_back(elements.epoch);
+    meanAnomaly.push_back(elements.meanAnomaly);
+    meanAnomalyRate.push_back(no + 0.5 * temp1 * rteosq * con41Value + 0.0625 * temp2 * rteosq * (13.0 - 78.0 * cosio2 + 137.0 * cosio4));
+    perigee.push_back(elements.argumentOfPerigee);
+    perigeeRate.push_back(-0.5 * temp1 * con42 + 0.0625 * temp2 * (7.0 - 114.0 * cosio2 + 395.0 * cosio4)
+                          + temp3 * (3.0 - 36.0 * cosio2 + 49.0 * cosio4));
+    node.push_back(elements.ascendingNode);
+    nodeRate.push_back(xhdot1 + (0.5 * temp2 * (4.0 - 19.0 * cosio2) + 2.0 * temp3 * (3.0 - 7.0 * cosio2)) * cosio);
+    nodeDrag.push_back(3.5 * omeosq * xhdot1 * c1);
+    cc1.push_back(c1);
+    cc4.push_back(bstar * c4);
+    t2cof.push_back(1.5 * c1);
+    eta.push_back(etaValue);
+    const double delmotemp = 1.0 + etaValue * std::cos(elements.meanAnomaly);
+    delmo.push_back(delmotemp * delmotemp * delmotemp);
+    sinmao.push_back(std::sin(elements.meanAnomaly));
+
+    // 只有完整模型才有的高阶项，简化模型置零
+    if (simple) {
+        cc5.push_back(0.0);
+        omgcof.push_back(0.0);
+        xmcof.push_back(0.0);
+        d2.push_back(0.0);
+        d3.push_back(0.0);
+        d4.push_back(0.0);
+        t3cof.push_back(0.0);
+        t4cof.push_back(0.0);
+        t5cof.push_back(0.0);
+    } else {
+        const double cc1sq = c1 * c1;
+        const double d2Value = 4.0 * ao * tsi * cc1sq;
+        const double temp = d2Value * tsi * c1 / 3.0;
+        const double d3Value = (17.0 * ao + sfour) * temp;
+        const double d4Value = 0.5 * temp * ao * tsi * (221.0 * ao + 31.0 * sfour) * c1;
+        cc5.push_back(bstar * c5);
+        omgcof.push_back(bstar * cc3 * std::cos(elements.argumentOfPerigee));
+        xmcof.push_back(ecc > 1.0e-4 ? -X2O3 * coef * bstar / eeta : 0.0);
+        d2.push_back(d2Value);
+        d3.push_back(d3Value);
+        d4.push_back(d4Value);
+        t3cof.push_back(d2Value + 2.0 * cc1sq);
+        t4cof.push_back(0.25 * (3.0 * d3Value + c1 * (12.0 * d2Value + 10.0 * cc1sq)));
+        t5cof.push_back(0.2 * (3.0 * d4Value + 12.0 * c1 * d3Value + 6.0 * d2Value * d2Value + 15.0 * cc1sq * (2.0 * d2Value + cc1sq)));
+    }
+
+    eccentricity.push_back(ecc);
+    inclination.push_back(inc);
+    sinInclination.push_back(sinio);
+    cosInclination.push_back(cosio);
+    semiMajorAxis.push_back(ao);
+    meanMotion.push_back(no);
+    // 倾角为180°时1 + cos i为零，按参考实现换成1.5e-12
+    const double onePlusCos = std::fabs(cosio + 1.0) > 1.5e-12 ? 1.0 + cosio : 1.5e-12;
+    xlcof.push_back(-0.25 * J3OJ2 * sinio * (3.0 + 5.0 * cosio) / onePlusCos);
+    aycof.push_back(-0.5 * J3OJ2 * sinio);
+    con41.push_back(con41Value);
+    x1mth2.push_back(x1mth2Value);
+    x7thm1.push_back(7.0 * cosio2 - 1.0);
+    x.push_back(0.0);
+    y.push_back(0.0);
+    z.push_back(0.0);
+    deepSpace += deep ? 1 : 0;
+    return true;
+}
+
+void Sgp4Batch::Clear()
+{
+    for (std::vector<double>* v : { &epoch, &meanAnomaly, &meanAnomalyRate, &perigee, &perigeeRate, &node, &nodeRate, &nodeDrag,
+                                    &cc1, &cc4, &cc5, &t2cof, &t3cof, &t4cof, &t5cof, &d2, &d3, &d4,
+                                    &omgcof, &xmcof, &eta, &delmo, &sinmao,
+                                    &eccentricity, &inclination, &sinInclination, &cosInclination, &semiMajorAxis, &meanMotion,
+                                    &aycof, &xlcof, &con41, &x1mth2, &x7thm1, &x, &y, &z }) {
+        v->clear();
+    }
+    deepSpace = 0;
+}
+
+void Sgp4Batch::Propagate(double day, ThreadPool* pool)
+{
+    if (pool == nullptr) {
+        Propagate(day, 0, Size());
+        return;
+    }
+    pool->ParallelFor(0, Size(), PROPAGATE_GRAIN, [this, day](size_t begin, size_t end) {
+        Propagate(day, begin, end);
+    });
+}
+
+void Sgp4Batch::Propagate(double day, size_t begin, size_t end)
+{
+    const Sgp4Arrays arrays = {
+        epoch.data(), meanAnomaly.data(), meanAnomalyRate.data(), perigee.data(), perigeeRate.data(),
+        node.data(), nodeRate.data(), nodeDrag.data(),
+        cc1.data(), cc4.data(), cc5.data(), t2cof.data(), t3cof.data(), t4cof.data(), t5cof.data(),
+        d2.data(), d3.data(), d4.data(),
+        omgcof.data(), xmcof.data(), eta.data(), delmo.data(), sinmao.data(),
+        eccentricity.data(), inclination.data(), sinInclination.data(), cosInclination.data(), semiMajorAxis.data(), meanMotion.data(),
+        aycof.data(), xlcof.data(), con41.data(), x1mth2.data(), x7thm1.data(),
+        x.data(), y.data(), z.data()
+    };
+    propagateRange(arrays, day, begin, end);
+}
@@ -0,0 +1,56 @@
+#include "../include/simulation_clock.h"
+#include <cmath>
+
+SimulationClock::SimulationClock(double step, double maxFrameTime)
+    : step(step), maxFrameTime(maxFrameTime), warp(1.0), accumulator(0.0), time(0.0), steps(0)
+{
+}
+
+void SimulationClock::Advance(double frameTime)
+{
+    if (frameTime < 0.0) {
+        frameTime = 0.0;
+    }
+    if (frameTime > maxFrameTime) {
+        frameTime = maxFrameTime;
+    }
+    accumulator += frameTime * warp;
+}
+
+bool SimulationClock::Step()
+{
+    if (accumulator < step) {
+        return false;
+    }
+    accumulator -= step;
+    time += step;
+    steps++;
+    return true;
+}
+
+void SimulationClock::Drop()
+{
+    accumulator = std::fmod(accumulator, step);
+}
+
+float SimulationClock::Alpha() const
+{
+    return static_cast<float>(accumulator / step);
+}
+
+void SimulationClock::SetStepSize(double newStep)
+{
+    step = newStep;
+}
+
+void SimulationClock::SetWarp(double newWarp)
+{
+    warp = newWarp;
+}
+
+void SimulationClock::Restore(unsigned long long restoredSteps, double restoredTime)
+{
+    steps = restoredSteps;
+    time = restoredTime;
+    accumulator = 0.0;
+}
@@ -0,0 +1,201 @@
+#include "../include/snapshot.h"
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+namespace {
+
+const char SNAPSHOT_MAGIC[8] = { 'S', 'O', 'L', 'A', 'R', 'S', 'N', 'P' };
+const uint32_t SNAPSHOT_BYTE_ORDER = 0x01020304;
+
+// N体状态的分量数
+const size_t NBODY_COMPONENTS = 7;
+
+// 文件头没有填充字节，布局与编译器无关
+static_assert(sizeof(SnapshotHeader) == 120, "SnapshotHeader layout changed, bump SNAPSHOT_VERSION");
+
+size_t alignUp(size_t offset)
+{
+    return (offset + SNAPSHOT_ALIGNMENT - 1) / SNAPSHOT_ALIGNMENT * SNAPSHOT_ALIGNMENT;
+}
+
+// 写出数据并补零到下一个对齐位置
+bool writeAligned(FILE* file, const void* data, size_t size, size_t& offset)
+{
+    static const char zeros[SNAPSHOT_ALIGNMENT] = {};
+    if (size > 0 && std::fwrite(data, 1, size, file) != size) {
+        return false;
+    }
+    offset += size;
+    const size_t padding = alignUp(offset) - offset;
+    if (padding > 0 && std::fwrite(zeros, 1, padding, file) != padding) {
+        return false;
+    }
+    offset += padding;
+    return true;
+}
+
+} // namespace
+
+SnapshotWriter::SnapshotWriter()
+    : pending(false), stopping(false)
+{
+    worker = std::thread(&SnapshotWriter::WorkerLoop, this);
+}
+
+SnapshotWriter::~SnapshotWriter()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_one();
+    worker.join();
+}
+
+bool SnapshotWriter::Save(const std::string& newPath, SnapshotData&& newData)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (pending) {
+            return false;
+        }
+        path = newPath;
+        data = std::move(newData);
+        pending = true;
+    }
+    wake.notify_one();
+    return true;
+}
+
+bool SnapshotWriter::Busy()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return pending;
+}
+
+SnapshotData SnapshotWriter::Recycle()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    SnapshotData recycled = std::move(spare);
+    spare = SnapshotData();
+    recycled.orbitAngles.clear();
+    recycled.rotationAngles.clear();
+    recycled.nbodyState.clear();
+    return recycled;
+}
+
+void SnapshotWriter::WorkerLoop()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    for (;;) {
+        wake.wait(lock, [this] { return pending || stopping; });
+        if (pending) {
+            // 写文件期间不持有锁，Busy()不会被阻塞
+            lock.unlock();
+            if (Write(path, data)) {
+                std::cout << "Snapshot saved: " << path << " (step " << data.steps << ")" << std::endl;
+            } else {
+                std::cerr << "Failed to save snapshot: " << path << std::endl;
+            }
+            lock.lock();
+            spare = std::move(data);
+            data = SnapshotData();
+            pending = false;
+        } else if (stopping) {
+            return;
+        }
+    }
+}
+
+bool SnapshotWriter::Write(const std::string& path, const SnapshotData& data)
+{
+    const size_t bodyCount = data.orbitAngles.size();
+
+    SnapshotHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic));
+    header.version = SNAPSHOT_VERSION;
+    header.byteOrder = SNAPSHOT_BYTE_ORDER;
+    header.flags = data.flags;
+    header.steps = data.steps;
+    header.time = data.time;
+    header.bodyCount = bodyCount;
+    header.anglesOffset = alignUp(sizeof(SnapshotHeader));
+    header.nbodyCount = data.nbodyCount;
+    header.nbodyOffset = alignUp(header.anglesOffset + alignUp(bodyCount * sizeof(double)) + bodyCount * sizeof(float));
+    header.fileSize = alignUp(header.nbodyOffset + NBODY_COMPONENTS * data.nbodyCount * sizeof(double));
+    header.gravity = data.gravity;
+    header.softening = data.softening;
+    header.theta = data.theta;
+    header.orbitTime = data.orbitTime;
+    header.sceneHash = data.sceneHash;
+
+    const std::string temporary = path + ".tmp";
+    FILE* file = std::fopen(temporary.c_str(), "wb");
+    if (file == nullptr) {
+        return false;
+    }
+
+    // 公转角和自转角各自对齐，N体的各分量连续存放（每个分量长度相同，整段只对齐一次）
+    size_t offset = 0;
+    bool ok = writeAligned(file, &header, sizeof(header), offset)
+           && writeAligned(file, data.orbitAngles.data(), bodyCount * sizeof(double), offset)
+           && writeAligned(file, data.rotationAngles.data(), bodyCount * sizeof(float), offset)
+           && writeAligned(file, data.nbodyState.data(), data.nbodyState.size() * sizeof(double), offset);
+    ok = ok && offset == header.fileSize;
+    ok = (std::fclose(file) == 0) && ok;
+    if (!ok || std::rename(temporary.c_str(), path.c_str()) != 0) {
+        std::remove(temporary.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool SnapshotReader::Open(const char* path)
+{
+    header = nullptr;
+    if (!file.Open(path) || file.Size() < sizeof(SnapshotHeader)) {
+        return false;
+    }
+
+    const SnapshotHeader* h = reinterpret_cast<const SnapshotHeader*>(file.Data());
+    if (std::memcmp(h->magic, SNAPSHOT_MAGIC, sizeof(h->magic)) != 0 || h->version != SNAPSHOT_VERSION
+        || h->byteOrder != SNAPSHOT_BYTE_ORDER || h->fileSize != file.Size()) {
+        return false;
+    }
+
+    // 各段必须对齐并且完整地落在文件内。先确认起点在文件内，再用剩余字节数比较长度，
+    // 文件中的偏移和数量再大也不会在相加或相乘时回绕
+    const uint64_t size = file.Size();
+    if (h->anglesOffset % SNAPSHOT_ALIGNMENT != 0 || h->nbodyOffset % SNAPSHOT_ALIGNMENT != 0
+        || h->anglesOffset > size || h->nbodyOffset > size
+        || h->bodyCount > size / (sizeof(double) + sizeof(float)) || h->nbodyCount > size / (NBODY_COMPONENTS * sizeof(double))) {
+        return false;
+    }
+    // 角度段在N体段之前，N体段到文件末尾为止
+    const uint64_t anglesBytes = alignUp(h->bodyCount * sizeof(double)) + h->bodyCount * sizeof(float);
+    const uint64_t nbodyBytes = NBODY_COMPONENTS * h->nbodyCount * sizeof(double);
+    if (h->anglesOffset > h->nbodyOffset || anglesBytes > h->nbodyOffset - h->anglesOffset
+        || nbodyBytes > size - h->nbodyOffset) {
+        return false;
+    }
+
+    header = h;
+    return true;
+}
+
+const double* SnapshotReader::OrbitAngles() const
+{
+    return reinterpret_cast<const double*>(file.Data() + header->anglesOffset);
+}
+
+const float* SnapshotReader::RotationAngles() const
+{
+    return reinterpret_cast<const float*>(file.Data() + header->anglesOffset + alignUp(header->bodyCount * sizeof(double)));
+}
+
+const double* SnapshotReader::NBody(int component) const
+{
+    return reinterpret_cast<const double*>(file.Data() + header->nbodyOffset) + component * header->nbodyCount;
+}
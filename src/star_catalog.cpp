@@ -0,0 +1,102 @@
+#include "../include/star_catalog.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+namespace {
+
+const char STAR_CATALOG_MAGIC[8] = { 'S', 'O', 'L', 'A', 'R', 'S', 'T', 'R' };
+const uint32_t STAR_CATALOG_BYTE_ORDER = 0x01020304;
+
+// 文件头和记录都没有填充字节，布局与编译器无关
+static_assert(sizeof(StarCatalogHeader) == 48, "StarCatalogHeader layout changed, bump STAR_CATALOG_VERSION");
+static_assert(sizeof(StarRecord) == 20, "StarRecord layout changed, bump STAR_CATALOG_VERSION");
+
+size_t alignUp(size_t offset)
+{
+    return (offset + STAR_CATALOG_ALIGNMENT - 1) / STAR_CATALOG_ALIGNMENT * STAR_CATALOG_ALIGNMENT;
+}
+
+} // namespace
+
+bool WriteStarCatalog(const char* path, std::vector<StarRecord> stars)
+{
+    // 从亮到暗排序，读取方按星等截取时只需要前缀
+    std::stable_sort(stars.begin(), stars.end(), [](const StarRecord& a, const StarRecord& b) {
+        return a.magnitude < b.magnitude;
+    });
+
+    StarCatalogHeader header = {};
+    std::memcpy(header.magic, STAR_CATALOG_MAGIC, sizeof(header.magic));
+    header.version = STAR_CATALOG_VERSION;
+    header.byteOrder = STAR_CATALOG_BYTE_ORDER;
+    header.count = stars.size();
+    header.starsOffset = alignUp(sizeof(StarCatalogHeader));
+    header.fileSize = header.starsOffset + stars.size() * sizeof(StarRecord);
+    header.recordSize = sizeof(StarRecord);
+
+    // 先写临时文件再改名，不会留下写了一半的星表
+    const std::string temporary = std::string(path) + ".tmp";
+    FILE* file = std::fopen(temporary.c_str(), "wb");
+    if (file == nullptr) {
+        return false;
+    }
+    static const char zeros[STAR_CATALOG_ALIGNMENT] = {};
+    const size_t padding = header.starsOffset - sizeof(header);
+    bool ok = std::fwrite(&header, sizeof(header), 1, file) == 1
+           && std::fwrite(zeros, 1, padding, file) == padding
+           && (stars.empty() || std::fwrite(stars.data(), sizeof(StarRecord), stars.size(), file) == stars.size());
+    ok = (std::fclose(file) == 0) && ok;
+    if (!ok || std::rename(temporary.c_str(), path) != 0) {
+        std::remove(temporary.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool StarCatalog::Open(const char* path)
+{
+    header = nullptr;
+    if (!file.Open(path) || file.Size() < sizeof(StarCatalogHeader)) {
+        return false;
+    }
+
+    const StarCatalogHeader* h = reinterpret_cast<const StarCatalogHeader*>(file.Data());
+    if (std::memcmp(h->magic, STAR_CATALOG_MAGIC, sizeof(h->magic)) != 0 || h->version != STAR_CATALOG_VERSION
+        || h->byteOrder != STAR_CATALOG_BYTE_ORDER || h->fileSize != file.Size() || h->recordSize != sizeof(StarRecord)) {
+        return false;
+    }
+
+    // 记录段必须对齐并且完整地落在文件内：先确认起点在文件内，再与剩余字节数比较，偏移再大也不会回绕
+    if (h->starsOffset % STAR_CATALOG_ALIGNMENT != 0 || h->starsOffset > file.Size() || h->count > file.Size()
+        || h->count * sizeof(StarRecord) > file.Size() - h->starsOffset) {
+        return false;
+    }
+
+    header = h;
+    return true;
+}
+
+void StarCatalog::Close()
+{
+    header = nullptr;
+    file.Close();
+}
+
+const StarRecord* StarCatalog::Stars() const
+{
+    return reinterpret_cast<const StarRecord*>(file.Data() + header->starsOffset);
+}
+
+size_t StarCatalog::CountBrighterThan(float limit) const
+{
+    if (header == nullptr) {
+        return 0;
+    }
+    const StarRecord* first = Stars();
+    const StarRecord* last = first + Size();
+    return std::upper_bound(first, last, limit, [](float value, const StarRecord& star) {
+        return value < star.magnitude;
+    }) - first;
+}
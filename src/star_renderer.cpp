@@ -0,0 +1,64 @@
+#include "../include/star_renderer.h"
+#include <cstddef>
+
+// 创建着色器程序
+GLuint createShaderProgram(const char* vertexSource, const char* fragmentSource);
+
+StarRenderer::StarRenderer()
+    : count(0)
+{
+    // 加载并创建着色器程序
+    this->shader = createShaderProgram("shaders/star_vertex.glsl", "shaders/star_fragment.glsl");
+    this->magnitudeLimitLocation = glGetUniformLocation(this->shader, "magnitudeLimit");
+
+    // 配置VAO/VBO，顶点格式与StarRecord一致：方向、星等、色指数
+    glGenVertexArrays(1, &this->VAO);
+    glGenBuffers(1, &this->VBO);
+    glBindVertexArray(this->VAO);
+    glBindBuffer(GL_ARRAY_BUFFER, this->VBO);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(StarRecord), (void*)offsetof(StarRecord, x));
+    glVertexAttribPointer(1, 1, GL_FLOAT, GL_FALSE, sizeof(StarRecord), (void*)offsetof(StarRecord, magnitude));
+    glVertexAttribPointer(2, 1, GL_FLOAT, GL_FALSE, sizeof(StarRecord), (void*)offsetof(StarRecord, colorIndex));
+    glEnableVertexAttribArray(0);
+    glEnableVertexAttribArray(1);
+    glEnableVertexAttribArray(2);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindVertexArray(0);
+}
+
+StarRenderer::~StarRenderer()
+{
+    // 清理资源
+    glDeleteVertexArrays(1, &this->VAO);
+    glDeleteBuffers(1, &this->VBO);
+    glDeleteProgram(this->shader);
+}
+
+void StarRenderer::Upload(const StarCatalog& catalog)
+{
+    this->count = catalog.Size();
+    glBindBuffer(GL_ARRAY_BUFFER, this->VBO);
+    glBufferData(GL_ARRAY_BUFFER, this->count * sizeof(StarRecord), this->count > 0 ? catalog.Stars() : NULL, GL_STATIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void StarRenderer::Draw(size_t visible, float magnitudeLimit)
+{
+    if (visible == 0) {
+        return;
+    }
+
+    // 恒星在无穷远处，不参与深度测试也不遮挡任何东西
+    glDisable(GL_DEPTH_TEST);
+    glDepthMask(GL_FALSE);
+
+    glUseProgram(this->shader);
+    glUniform1f(this->magnitudeLimitLocation, magnitudeLimit);
+
+    glBindVertexArray(this->VAO);
+    glDrawArrays(GL_POINTS, 0, static_cast<GLsizei>(visible < this->count ? visible : this->count));
+    glBindVertexArray(0);
+
+    glDepthMask(GL_TRUE);
+    glEnable(GL_DEPTH_TEST);
+}
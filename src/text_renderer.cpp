@@ -1,5 +1,7 @@
 #include "../include/text_renderer.h"
 #include <iostream>
+#include <cstddef>
+#include <algorithm>
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
@@ -12,36 +14,40 @@ std::string loadShaderSource(const char* filePath);
 // 创建着色器程序
 GLuint createShaderProgram(const char* vertexSource, const char* fragmentSource);
 
-TextRenderer::TextRenderer(unsigned int width, unsigned int height)
+// 字形图集的宽度（像素），高度按需要计算
+const int ATLAS_WIDTH = 512;
+
+TextRenderer::TextRenderer()
+    : ftInitialized(false), current(nullptr), capacity(0), retainedDirty(false), retainedUploaded(false)
 {
-    // 加载并创建着色器程序
+    // 加载并创建着色器程序，屏幕投影矩阵来自FrameData uniform块
     this->shader = createShaderProgram("shaders/text_vertex.glsl", "shaders/text_fragment.glsl");
     
-    // 设置投影矩阵
-    this->projection = glm::ortho(0.0f, static_cast<float>(width), 0.0f, static_cast<float>(height));
-    
-    // 设置着色器变量
-    glUseProgram(this->shader);
-    glUniformMatrix4fv(glGetUniformLocation(this->shader, "projection"), 1, GL_FALSE, glm::value_ptr(this->projection));
-    
-    // 配置VAO/VBO用于文本四边形
+    // 配置VAO/VBO用于文本顶点，缓冲区大小按需增长
     glGenVertexArrays(1, &this->VAO);
     glGenBuffers(1, &this->VBO);
     glBindVertexArray(this->VAO);
     glBindBuffer(GL_ARRAY_BUFFER, this->VBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(float) * 6 * 4, NULL, GL_DYNAMIC_DRAW);
     glEnableVertexAttribArray(0);
-    glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(float), 0);
+    glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, sizeof(TextVertex), (void*)offsetof(TextVertex, x));
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(TextVertex), (void*)offsetof(TextVertex, r));
     glBindBuffer(GL_ARRAY_BUFFER, 0);
     glBindVertexArray(0);
+    
+    this->vertices.reserve(4096);
 }
 
 TextRenderer::~TextRenderer()
 {
     // 清理资源
-    for (auto& ch : Characters)
+    for (auto& font : this->fonts)
+    {
+        glDeleteTextures(1, &font.second.Atlas);
+    }
+    if (this->ftInitialized)
     {
-        glDeleteTextures(1, &ch.second.TextureID);
+        FT_Done_FreeType(this->ft);
     }
     glDeleteVertexArrays(1, &this->VAO);
     glDeleteBuffers(1, &this->VBO);
@@ -50,93 +56,173 @@ TextRenderer::~TextRenderer()
 
 bool TextRenderer::Load(std::string font, unsigned int fontSize)
 {
-    // 清除之前加载的字符
-    this->Characters.clear();
+    // 已缓存的字体直接切换
+    auto key = std::make_pair(font, fontSize);
+    auto cached = this->fonts.find(key);
+    if (cached != this->fonts.end())
+    {
+        if (this->current != &cached->second)
+        {
+            // 先画完用旧字体排好的文字，保留文本需要用新字体重新排版
+            DrawPending();
+            this->current = &cached->second;
+            this->retainedDirty = true;
+        }
+        return true;
+    }
     
-    // 初始化FreeType库
-    FT_Library ft;
-    if (FT_Init_FreeType(&ft))
+    // 初始化FreeType库（只初始化一次）
+    if (!this->ftInitialized)
     {
-        std::cout << "ERROR::FREETYPE: Could not init FreeType Library" << std::endl;
-        return false;
+        if (FT_Init_FreeType(&this->ft))
+        {
+            std::cout << "ERROR::FREETYPE: Could not init FreeType Library" << std::endl;
+            return false;
+        }
+        this->ftInitialized = true;
     }
     
     // 加载字体
     FT_Face face;
-    if (FT_New_Face(ft, font.c_str(), 0, &face))
+    if (FT_New_Face(this->ft, font.c_str(), 0, &face))
     {
         std::cout << "ERROR::FREETYPE: Failed to load font" << std::endl;
         return false;
     }
     
+    Font loaded;
+    
     // 设置字体大小
     FT_Set_Pixel_Sizes(face, 0, fontSize);
     
-    // 禁用字节对齐限制
-    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
-    
-    // 加载前128个ASCII字符
+    // 第一遍：光栅化前128个ASCII字符，暂存位图并按行排布到图集中
+    // 加载失败的字符保持空字形，位置为(0, 0)，第二遍不拷贝像素
+    std::vector<std::vector<unsigned char>> bitmaps(128);
+    glm::ivec2 positions[128] = {};
+    int penX = 1, penY = 1, rowHeight = 0;
     for (GLubyte c = 0; c < 128; c++)
     {
+        Character& ch = loaded.Characters[c];
+        ch = Character();
+        
         // 加载字符的字形
         if (FT_Load_Char(face, c, FT_LOAD_RENDER))
         {
-            std::cout << "ERROR::FREETYPE: Failed to load Glyph" << std::endl;
+            std::cout << "ERROR::FREETYPE: Failed to load Glyph " << static_cast<int>(c) << " in " << font << std::endl;
             continue;
         }
         
-        // 生成纹理
-        GLuint texture;
-        glGenTextures(1, &texture);
-        glBindTexture(GL_TEXTURE_2D, texture);
-        glTexImage2D(
-            GL_TEXTURE_2D,
-            0,
-            GL_RED,
-            face->glyph->bitmap.width,
-            face->glyph->bitmap.rows,
-            0,
-            GL_RED,
-            GL_UNSIGNED_BYTE,
-            face->glyph->bitmap.buffer
-        );
+        const FT_Bitmap& bitmap = face->glyph->bitmap;
+        ch.Size = glm::ivec2(bitmap.width, bitmap.rows);
+        ch.Bearing = glm::ivec2(face->glyph->bitmap_left, face->glyph->bitmap_top);
+        ch.Advance = static_cast<GLuint>(face->glyph->advance.x);
         
-        // 设置纹理选项
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        // 拷贝位图（去掉行对齐填充）
+        bitmaps[c].resize(bitmap.width * bitmap.rows);
+        for (unsigned int row = 0; row < bitmap.rows; ++row)
+        {
+            std::copy(bitmap.buffer + row * bitmap.pitch, bitmap.buffer + row * bitmap.pitch + bitmap.width, bitmaps[c].begin() + row * bitmap.width);
+        }
         
-        // 存储字符
-        Character character = {
-            texture,
-            glm::ivec2(face->glyph->bitmap.width, face->glyph->bitmap.rows),
-            glm::ivec2(face->glyph->bitmap_left, face->glyph->bitmap_top),
-            static_cast<GLuint>(face->glyph->advance.x)
-        };
-        Characters.insert(std::pair<char, Character>(c, character));
+        // 当前行放不下时换行，字形之间留1像素间隔防止采样串色
+        if (penX + ch.Size.x + 1 > ATLAS_WIDTH)
+        {
+            penX = 1;
+            penY += rowHeight + 1;
+            rowHeight = 0;
+        }
+        positions[c] = glm::ivec2(penX, penY);
+        penX += ch.Size.x + 1;
+        if (ch.Size.y > rowHeight)
+        {
+            rowHeight = ch.Size.y;
+        }
     }
     
+    // 第二遍：拼接图集并一次上传
+    int atlasHeight = penY + rowHeight + 1;
+    std::vector<unsigned char> pixels(ATLAS_WIDTH * atlasHeight, 0);
+    for (int c = 0; c < 128; c++)
+    {
+        Character& ch = loaded.Characters[c];
+        for (int row = 0; row < ch.Size.y; ++row)
+        {
+            std::copy(bitmaps[c].begin() + row * ch.Size.x, bitmaps[c].begin() + (row + 1) * ch.Size.x,
+                      pixels.begin() + (positions[c].y + row) * ATLAS_WIDTH + positions[c].x);
+        }
+        ch.UVMin = glm::vec2(positions[c].x / (float)ATLAS_WIDTH, positions[c].y / (float)atlasHeight);
+        ch.UVMax = glm::vec2((positions[c].x + ch.Size.x) / (float)ATLAS_WIDTH, (positions[c].y + ch.Size.y) / (float)atlasHeight);
+    }
+    
+    // 禁用字节对齐限制
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    
+    // 生成图集纹理
+    glGenTextures(1, &loaded.Atlas);
+    glBindTexture(GL_TEXTURE_2D, loaded.Atlas);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RED, ATLAS_WIDTH, atlasHeight, 0, GL_RED, GL_UNSIGNED_BYTE, pixels.data());
+    
+    // 设置纹理选项
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    
     // 清理资源
     FT_Done_Face(face);
-    FT_Done_FreeType(ft);
+    
+    // 放入缓存并切换过去
+    DrawPending();
+    this->current = &this->fonts.emplace(key, loaded).first->second;
+    this->retainedDirty = true;
     
     return true;
 }
 
-void TextRenderer::RenderText(std::string text, float x, float y, float scale, glm::vec3 color)
+void TextRenderer::RenderText(const std::string& text, float x, float y, float scale, glm::vec3 color)
 {
-    // 激活对应的渲染状态
-    glUseProgram(this->shader);
-    glUniform3f(glGetUniformLocation(this->shader, "textColor"), color.x, color.y, color.z);
-    glActiveTexture(GL_TEXTURE0);
-    glBindVertexArray(this->VAO);
+    Layout(this->vertices, text, x, y, scale, color);
+}
+
+int TextRenderer::CreateText()
+{
+    this->retained.push_back({ std::string(), 0.0f, 0.0f, 1.0f, glm::vec3(1.0f) });
+    return static_cast<int>(this->retained.size()) - 1;
+}
+
+void TextRenderer::SetText(int handle, const std::string& text, float x, float y, float scale, glm::vec3 color)
+{
+    RetainedText& t = this->retained[handle];
+    if (t.text == text && t.x == x && t.y == y && t.scale == scale && t.color == color)
+    {
+        return;
+    }
+    
+    t.text = text;
+    t.x = x;
+    t.y = y;
+    t.scale = scale;
+    t.color = color;
+    this->retainedDirty = true;
+}
+
+void TextRenderer::Layout(std::vector<TextVertex>& out, const std::string& text, float x, float y, float scale, glm::vec3 color) const
+{
+    if (this->current == nullptr)
+    {
+        return;
+    }
     
-    // 遍历文本中的所有字符
-    std::string::const_iterator c;
-    for (c = text.begin(); c != text.end(); c++)
+    // 遍历文本中的所有字符，生成字形四边形
+    for (std::string::const_iterator c = text.begin(); c != text.end(); c++)
     {
-        Character ch = Characters[*c];
+        unsigned char code = static_cast<unsigned char>(*c);
+        if (code >= 128)
+        {
+            continue;
+        }
+        const Character& ch = this->current->Characters[code];
         
         float xpos = x + ch.Bearing.x * scale;
         float ypos = y - (ch.Size.y - ch.Bearing.y) * scale;
@@ -144,32 +230,102 @@ void TextRenderer::RenderText(std::string text, float x, float y, float scale, g
         float w = ch.Size.x * scale;
         float h = ch.Size.y * scale;
         
-        // 为每个字符更新VBO
-        float vertices[6][4] = {
-            { xpos,     ypos + h,   0.0f, 0.0f },
-            { xpos,     ypos,       0.0f, 1.0f },
-            { xpos + w, ypos,       1.0f, 1.0f },
-            
-            { xpos,     ypos + h,   0.0f, 0.0f },
-            { xpos + w, ypos,       1.0f, 1.0f },
-            { xpos + w, ypos + h,   1.0f, 0.0f }
-        };
-        
-        // 渲染字形纹理
-        glBindTexture(GL_TEXTURE_2D, ch.TextureID);
-        
-        // 更新VBO内存
-        glBindBuffer(GL_ARRAY_BUFFER, this->VBO);
-        glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(vertices), vertices);
-        glBindBuffer(GL_ARRAY_BUFFER, 0);
-        
-        // 渲染四边形
-        glDrawArrays(GL_TRIANGLES, 0, 6);
+        // 空白字符不需要四边形
+        if (w > 0.0f && h > 0.0f)
+        {
+            TextVertex quad[6] = {
+                { xpos,     ypos + h, ch.UVMin.x, ch.UVMin.y, color.x, color.y, color.z },
+                { xpos,     ypos,     ch.UVMin.x, ch.UVMax.y, color.x, color.y, color.z },
+                { xpos + w, ypos,     ch.UVMax.x, ch.UVMax.y, color.x, color.y, color.z },
+                
+                { xpos,     ypos + h, ch.UVMin.x, ch.UVMin.y, color.x, color.y, color.z },
+                { xpos + w, ypos,     ch.UVMax.x, ch.UVMax.y, color.x, color.y, color.z },
+                { xpos + w, ypos + h, ch.UVMax.x, ch.UVMin.y, color.x, color.y, color.z }
+            };
+            out.insert(out.end(), quad, quad + 6);
+        }
         
         // 更新位置到下一个字形
         x += (ch.Advance >> 6) * scale; // 位偏移是以1/64像素表示的，所以需要除以64
     }
-    
+}
+
+void TextRenderer::Upload()
+{
+    const size_t retainedCount = this->retainedVertices.size();
+    const size_t total = retainedCount + this->vertices.size();
+    glBindBuffer(GL_ARRAY_BUFFER, this->VBO);
+    if (total > this->capacity)
+    {
+        // 重新分配后原有内容失效，保留文本也要重新上传
+        this->capacity = std::max(total, 2 * this->capacity);
+        glBufferData(GL_ARRAY_BUFFER, this->capacity * sizeof(TextVertex), NULL, GL_DYNAMIC_DRAW);
+        this->retainedUploaded = false;
+    }
+    if (!this->retainedUploaded)
+    {
+        if (retainedCount > 0)
+        {
+            glBufferSubData(GL_ARRAY_BUFFER, 0, retainedCount * sizeof(TextVertex), this->retainedVertices.data());
+        }
+        this->retainedUploaded = true;
+    }
+    if (!this->vertices.empty())
+    {
+        glBufferSubData(GL_ARRAY_BUFFER, retainedCount * sizeof(TextVertex), this->vertices.size() * sizeof(TextVertex), this->vertices.data());
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void TextRenderer::Draw(size_t first, size_t count)
+{
+    glUseProgram(this->shader);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, this->current->Atlas);
+    glBindVertexArray(this->VAO);
+    glDrawArrays(GL_TRIANGLES, first, count);
     glBindVertexArray(0);
     glBindTexture(GL_TEXTURE_2D, 0);
-} 
\ No newline at end of file
+}
+
+void TextRenderer::Flush()
+{
+    if (this->current == nullptr)
+    {
+        return;
+    }
+    
+    // 保留文本有变化时重新排版，随本帧追加的文本一起上传
+    if (this->retainedDirty)
+    {
+        this->retainedVertices.clear();
+        for (const RetainedText& t : this->retained)
+        {
+            Layout(this->retainedVertices, t.text, t.x, t.y, t.scale, t.color);
+        }
+        this->retainedUploaded = false;
+        this->retainedDirty = false;
+    }
+    
+    // 保留文本和本帧追加的文本在缓冲区中相邻，一次绘制
+    const size_t total = this->retainedVertices.size() + this->vertices.size();
+    if (total > 0)
+    {
+        Upload();
+        Draw(0, total);
+    }
+    this->vertices.clear();
+}
+
+void TextRenderer::DrawPending()
+{
+    if (this->current == nullptr || this->vertices.empty())
+    {
+        return;
+    }
+    
+    // 只画追加的部分，保留文本留到Flush时用新字体重新排版
+    Upload();
+    Draw(this->retainedVertices.size(), this->vertices.size());
+    this->vertices.clear();
+}
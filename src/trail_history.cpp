@@ -0,0 +1,108 @@
+#include "../include/trail_history.h"
+
+namespace {
+
+// 没有轨迹点时operator[]和Newest()返回的点（原点）
+const glm::vec3 NO_POINT(0.0f);
+
+} // namespace
+
+TrailHistory::TrailHistory(unsigned int capacity)
+    : origin(0.0), points(capacity), head(0), count(0),
+      segments((capacity + TRAIL_SEGMENT_POINTS - 1) / TRAIL_SEGMENT_POINTS)
+{
+    Clear();
+}
+
+void TrailHistory::Push(const glm::dvec3& worldPoint)
+{
+    if (points.empty()) {
+        return;
+    }
+
+    // 清空后的第一个点作为原点
+    if (count == 0) {
+        origin = worldPoint;
+    }
+    const glm::vec3 point(worldPoint - origin);
+
+    // 更新所在分段的包围盒
+    Segment& segment = segments[head / TRAIL_SEGMENT_POINTS];
+    const unsigned int offset = head % TRAIL_SEGMENT_POINTS;
+    if (offset == 0) {
+        segment.freshMin = segment.freshMax = point;
+    } else {
+        segment.freshMin = glm::min(segment.freshMin, point);
+        segment.freshMax = glm::max(segment.freshMax, point);
+    }
+    if (segment.valid) {
+        segment.boundsMin = glm::min(segment.boundsMin, point);
+        segment.boundsMax = glm::max(segment.boundsMax, point);
+    } else {
+        segment.boundsMin = segment.boundsMax = point;
+        segment.valid = true;
+    }
+    // 该段的旧点已全部被覆盖，包围盒收缩为新点的范围
+    if (offset == TRAIL_SEGMENT_POINTS - 1 || head == Capacity() - 1) {
+        segment.boundsMin = segment.freshMin;
+        segment.boundsMax = segment.freshMax;
+    }
+
+    // 覆盖最旧的点，不移动其余元素
+    points[head] = point;
+    head = (head + 1) % Capacity();
+    if (count < Capacity()) {
+        count++;
+    }
+}
+
+void TrailHistory::Clear()
+{
+    head = 0;
+    count = 0;
+    for (Segment& segment : segments) {
+        segment.valid = false;
+    }
+}
+
+bool TrailHistory::Intersects(const Frustum& frustum, const glm::vec3& offset) const
+{
+    for (const Segment& segment : segments) {
+        if (segment.valid && frustum.IntersectsBox(segment.boundsMin + offset, segment.boundsMax + offset)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+const glm::vec3& TrailHistory::operator[](unsigned int i) const
+{
+    // 容量为0（不记录轨迹的天体）或为空时没有点可取
+    if (count == 0) {
+        return NO_POINT;
+    }
+    // 最旧的点位于 head - count
+    return points[(head + Capacity() - count + i) % Capacity()];
+}
+
+const glm::vec3& TrailHistory::Newest() const
+{
+    if (count == 0) {
+        return NO_POINT;
+    }
+    return points[(head + Capacity() - 1) % Capacity()];
+}
+
+void TrailHistory::Spans(Span& first, Span& second) const
+{
+    const unsigned int start = (head + Capacity() - count) % (Capacity() > 0 ? Capacity() : 1);
+
+    if (start + count <= Capacity()) {
+        // 没有回绕，只有一段
+        first = { points.data() + start, count };
+        second = { points.data(), 0 };
+    } else {
+        first = { points.data() + start, Capacity() - start };
+        second = { points.data(), count - first.count };
+    }
+}
@@ -0,0 +1,157 @@
+#include "../include/trail_renderer.h"
+#include <glm/gtc/type_ptr.hpp>
+
+// 创建着色器程序
+GLuint createShaderProgram(const char* vertexSource, const char* fragmentSource);
+
+TrailRenderer::TrailRenderer(unsigned int capacity)
+    : capacity(capacity)
+{
+    // 加载并创建着色器程序
+    this->shader = createShaderProgram("shaders/trail_vertex.glsl", "shaders/trail_fragment.glsl");
+    this->trailFirstLocation = glGetUniformLocation(this->shader, "trailFirst");
+    this->trailCountLocation = glGetUniformLocation(this->shader, "trailCount");
+    this->trailOffsetLocation = glGetUniformLocation(this->shader, "trailOffset");
+
+    // 配置VAO/VBO，缓冲区在注册轨迹时分配
+    glGenVertexArrays(1, &this->VAO);
+    glGenBuffers(1, &this->VBO);
+    glBindVertexArray(this->VAO);
+    glBindBuffer(GL_ARRAY_BUFFER, this->VBO);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindVertexArray(0);
+}
+
+TrailRenderer::~TrailRenderer()
+{
+    // 清理资源
+    glDeleteVertexArrays(1, &this->VAO);
+    glDeleteBuffers(1, &this->VBO);
+    glDeleteProgram(this->shader);
+}
+
+int TrailRenderer::AddTrail()
+{
+    const GLsizeiptr regionSize = 2 * this->capacity * sizeof(glm::vec3);
+    const GLsizeiptr oldSize = this->trails.size() * regionSize;
+
+    // 新建一个更大的缓冲区，并把已有轨迹数据拷贝过去（只在初始化时发生）
+    GLuint newVBO;
+    glGenBuffers(1, &newVBO);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, newVBO);
+    glBufferData(GL_COPY_WRITE_BUFFER, oldSize + regionSize, nullptr, GL_DYNAMIC_DRAW);
+    if (oldSize > 0) {
+        glBindBuffer(GL_COPY_READ_BUFFER, this->VBO);
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, oldSize);
+        glBindBuffer(GL_COPY_READ_BUFFER, 0);
+    }
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+    glDeleteBuffers(1, &this->VBO);
+    this->VBO = newVBO;
+
+    // 重新绑定顶点属性到新缓冲区
+    glBindVertexArray(this->VAO);
+    glBindBuffer(GL_ARRAY_BUFFER, this->VBO);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindVertexArray(0);
+
+    this->trails.push_back({ 0, 0, true, glm::vec3(0.0f) });
+    return static_cast<int>(this->trails.size()) - 1;
+}
+
+void TrailRenderer::Push(int trail, const glm::vec3& point)
+{
+    Trail& t = this->trails[trail];
+
+    // 同时写入镜像区域的两半
+    const GLintptr base = static_cast<GLintptr>(trail) * 2 * this->capacity;
+    glBindBuffer(GL_ARRAY_BUFFER, this->VBO);
+    glBufferSubData(GL_ARRAY_BUFFER, (base + t.head) * sizeof(glm::vec3), sizeof(glm::vec3), glm::value_ptr(point));
+    glBufferSubData(GL_ARRAY_BUFFER, (base + t.head + this->capacity) * sizeof(glm::vec3), sizeof(glm::vec3), glm::value_ptr(point));
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    t.head = (t.head + 1) % this->capacity;
+    if (t.count < this->capacity) {
+        t.count++;
+    }
+}
+
+void TrailRenderer::Upload(int trail, const TrailHistory& history)
+{
+    Trail& t = this->trails[trail];
+
+    // 最多保留capacity个最新的点
+    TrailHistory::Span first, second;
+    history.Spans(first, second);
+    unsigned int excess = first.count + second.count > this->capacity ? first.count + second.count - this->capacity : 0;
+    unsigned int skip = excess < first.count ? excess : first.count;
+    first.data += skip;
+    first.count -= skip;
+    second.data += excess - skip;
+    second.count -= excess - skip;
+    const unsigned int count = first.count + second.count;
+
+    // 两段按时间顺序写到镜像区域两半的开头
+    const GLintptr base = static_cast<GLintptr>(trail) * 2 * this->capacity;
+    glBindBuffer(GL_ARRAY_BUFFER, this->VBO);
+    for (unsigned int half = 0; half < 2; ++half) {
+        GLintptr offset = base + half * this->capacity;
+        if (first.count > 0) {
+            glBufferSubData(GL_ARRAY_BUFFER, offset * sizeof(glm::vec3), first.count * sizeof(glm::vec3), first.data);
+        }
+        if (second.count > 0) {
+            glBufferSubData(GL_ARRAY_BUFFER, (offset + first.count) * sizeof(glm::vec3), second.count * sizeof(glm::vec3), second.data);
+        }
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    t.head = count % this->capacity;
+    t.count = count;
+}
+
+void TrailRenderer::Clear(int trail)
+{
+    this->trails[trail].head = 0;
+    this->trails[trail].count = 0;
+}
+
+void TrailRenderer::SetVisible(int trail, bool visible)
+{
+    this->trails[trail].visible = visible;
+}
+
+void TrailRenderer::SetOffset(int trail, const glm::vec3& offset)
+{
+    this->trails[trail].offset = offset;
+}
+
+void TrailRenderer::Draw()
+{
+    // 使用轨迹着色器
+    glUseProgram(this->shader);
+
+    // 启用线宽
+    glLineWidth(1.5f);
+
+    glBindVertexArray(this->VAO);
+    for (size_t i = 0; i < this->trails.size(); ++i) {
+        const Trail& t = this->trails[i];
+        if (t.count < 2 || !t.visible) {
+            continue;
+        }
+
+        // 最近的count个点在镜像区域中连续存放，结束于 head + capacity
+        GLint first = static_cast<GLint>(i * 2 * this->capacity + t.head + this->capacity - t.count);
+        glUniform1i(this->trailFirstLocation, first);
+        glUniform1i(this->trailCountLocation, t.count);
+        glUniform3fv(this->trailOffsetLocation, 1, glm::value_ptr(t.offset));
+
+        // 绘制线条
+        glDrawArrays(GL_LINE_STRIP, first, t.count);
+    }
+    glBindVertexArray(0);
+}
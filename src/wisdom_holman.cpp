@@ -0,0 +1,115 @@
+#include "../include/wisdom_holman.h"
+#include "../include/kepler.h"
+#include <cmath>
+
+WisdomHolman::WisdomHolman(double gravity, double centralMass)
+    : gravity(gravity), centralMass(centralMass), prepared(true)
+{
+}
+
+size_t WisdomHolman::Add(double m, double px, double py, double pz, double pvx, double pvy, double pvz)
+{
+    x.push_back(px);
+    y.push_back(py);
+    z.push_back(pz);
+    vx.push_back(pvx);
+    vy.push_back(pvy);
+    vz.push_back(pvz);
+    mass.push_back(m);
+    prepared = false;
+    return mass.size() - 1;
+}
+
+void WisdomHolman::Prepare()
+{
+    if (prepared) {
+        return;
+    }
+
+    // 质心速度 = 日心速度 - Σ m_i v_i / M
+    double totalMass = centralMass;
+    double px = 0.0, py = 0.0, pz = 0.0;
+    for (size_t i = 0; i < mass.size(); ++i) {
+        totalMass += mass[i];
+        px += mass[i] * vx[i];
+        py += mass[i] * vy[i];
+        pz += mass[i] * vz[i];
+    }
+    for (size_t i = 0; i < mass.size(); ++i) {
+        vx[i] -= px / totalMass;
+        vy[i] -= py / totalMass;
+        vz[i] -= pz / totalMass;
+    }
+    prepared = true;
+}
+
+void WisdomHolman::Step(double dt)
+{
+    Prepare();
+
+    const double halfDt = 0.5 * dt;
+    InteractionKick(halfDt);
+    Jump(halfDt);
+    KeplerDrift(x.data(), y.data(), z.data(), vx.data(), vy.data(), vz.data(), mass.size(), gravity * centralMass, dt);
+    Jump(halfDt);
+    InteractionKick(halfDt);
+}
+
+void WisdomHolman::InteractionKick(double dt)
+{
+    const size_t n = mass.size();
+    for (size_t i = 0; i < n; ++i) {
+        for (size_t j = i + 1; j < n; ++j) {
+            double dx = x[j] - x[i], dy = y[j] - y[i], dz = z[j] - z[i];
+            double r2 = dx * dx + dy * dy + dz * dz;
+            double s = gravity * dt / (r2 * std::sqrt(r2));
+            vx[i] += mass[j] * s * dx;
+            vy[i] += mass[j] * s * dy;
+            vz[i] += mass[j] * s * dz;
+            vx[j] -= mass[i] * s * dx;
+            vy[j] -= mass[i] * s * dy;
+            vz[j] -= mass[i] * s * dz;
+        }
+    }
+}
+
+void WisdomHolman::Jump(double dt)
+{
+    // 所有行星一起平移 dt * Σ m_i v_i / m0
+    double px = 0.0, py = 0.0, pz = 0.0;
+    for (size_t i = 0; i < mass.size(); ++i) {
+        px += mass[i] * vx[i];
+        py += mass[i] * vy[i];
+        pz += mass[i] * vz[i];
+    }
+    const double s = dt / centralMass;
+    for (size_t i = 0; i < mass.size(); ++i) {
+        x[i] += px * s;
+        y[i] += py * s;
+        z[i] += pz * s;
+    }
+}
+
+double WisdomHolman::Energy()
+{
+    Prepare();
+
+    // 中心天体的质心速度 V0 = -Σ m_i v_i / m0
+    double px = 0.0, py = 0.0, pz = 0.0;
+    for (size_t i = 0; i < mass.size(); ++i) {
+        px += mass[i] * vx[i];
+        py += mass[i] * vy[i];
+        pz += mass[i] * vz[i];
+    }
+    double energy = 0.5 * (px * px + py * py + pz * pz) / centralMass;
+
+    for (size_t i = 0; i < mass.size(); ++i) {
+        energy += 0.5 * mass[i] * (vx[i] * vx[i] + vy[i] * vy[i] + vz[i] * vz[i]);
+        energy -= gravity * centralMass * mass[i] / std::sqrt(x[i] * x[i] + y[i] * y[i] + z[i] * z[i]);
+        for (size_t j = i + 1; j < mass.size(); ++j) {
+            double dx = x[j] - x[i], dy = y[j] - y[i], dz = z[j] - z[i];
+            energy -= gravity * mass[i] * mass[j] / std::sqrt(dx * dx + dy * dy + dz * dz);
+        }
+    }
+    return energy;
+}
@@ -0,0 +1,178 @@
+// 生成切比雪夫星历文件
+//   make_ephemeris <output> [startYear] [endYear]   默认覆盖1600-2600年
+// 行星位置取自JPL公布的近似开普勒根数及其世纪变化率（Standish, "Keplerian Elements for Approximate
+// Positions of the Major Planets"，表1），按DE星历的分段方式拟合成切比雪夫系数，并报告拟合误差。
+// 表1的根数在1800-2050年之间误差为角分量级，超出这个范围时精度逐渐下降
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "../include/ephemeris.h"
+
+namespace {
+
+const double PI = 3.14159265358979323846;
+const double DEG = PI / 180.0;
+const double J2000 = 2451545.0;
+const double DAYS_PER_CENTURY = 36525.0;
+const double DAYS_PER_YEAR = 365.25;
+const double KM_PER_AU = 149597870.7;
+
+// 每段32天，与DE星历相同
+const double SEGMENT_DAYS = 32.0;
+
+// 一个行星的根数：J2000的值和每世纪的变化率
+// a (AU), e, I (度), L 平黄经 (度), ϖ 近日点黄经 (度), Ω 升交点黄经 (度)
+struct PlanetElements {
+    const char* name;
+    double a, e, I, L, perihelion, node;
+    double aRate, eRate, IRate, LRate, perihelionRate, nodeRate;
+    uint32_t coefficients;
+    uint32_t subintervals;
+};
+
+// 地球一项实际是地月质心；系数个数和子区间数参照DE430
+const PlanetElements PLANETS[] = {
+    { "Mercury",  0.38709927, 0.20563593,  7.00497902, 252.25032350,  77.45779628,  48.33076593,
+                  0.00000037, 0.00001906, -0.00594749, 149472.67411175, 0.16047689, -0.12534081, 14, 4 },
+    { "Venus",    0.72333566, 0.00677672,  3.39467605, 181.97909950, 131.60246718,  76.67984255,
+                  0.00000390, -0.00004107, -0.00078890, 58517.81538729, 0.00268329, -0.27769418, 10, 2 },
+    { "Earth",    1.00000261, 0.01671123, -0.00001531, 100.46457166, 102.93768193,   0.0,
+                  0.00000562, -0.00004392, -0.01294668, 35999.37244981, 0.32327364,  0.0,        13, 2 },
+    { "Mars",     1.52371034, 0.09339410,  1.84969142,  -4.55343205, -23.94362959,  49.55953891,
+                  0.00001847, 0.00007882, -0.00813131, 19140.30268499, 0.44441088, -0.29257343, 11, 1 },
+    { "Jupiter",  5.20288700, 0.04838624,  1.30439695,  34.39644051,  14.72847983, 100.47390909,
+                 -0.00011607, -0.00013253, -0.00183714, 3034.74612775, 0.21252668,  0.20469106,  8, 1 },
+    { "Saturn",   9.53667594, 0.05386179,  2.48599187,  49.95424423,  92.59887831, 113.66242448,
+                 -0.00125060, -0.00050991, 0.00193609, 1222.49362201, -0.41897216, -0.28867794,  7, 1 },
+    { "Uranus",  19.18916464, 0.04725744,  0.77263783, 313.23810451, 170.95427630,  74.01692503,
+                 -0.00196176, -0.00004397, -0.00242939, 428.48202785, 0.40805281,  0.04240589,  6, 1 },
+    { "Neptune", 30.06992276, 0.00859048,  1.77004347, -55.12002969,  44.96476227, 131.78422574,
+                  0.00026291, 0.00005105, 0.00035372, 218.45945325, -0.32241464, -0.00508664,  6, 1 },
+    { "Pluto",   39.48211675, 0.24882730, 17.14001206, 238.92903833, 224.06891629, 110.30393684,
+                 -0.00031596, 0.00005170, 0.00004818, 145.20780515, -0.04062942, -0.01183482,  6, 1 },
+};
+
+// 儒略日day时行星的日心黄道坐标（AU）
+void planetPosition(const PlanetElements& p, double day, double position[3])
+{
+    const double T = (day - J2000) / DAYS_PER_CENTURY;
+    const double a = p.a + p.aRate * T;
+    const double e = p.e + p.eRate * T;
+    const double I = (p.I + p.IRate * T) * DEG;
+    const double L = (p.L + p.LRate * T) * DEG;
+    const double perihelion = (p.perihelion + p.perihelionRate * T) * DEG;
+    const double node = (p.node + p.nodeRate * T) * DEG;
+    const double omega = perihelion - node;
+    const double M = std::remainder(L - perihelion, 2.0 * PI);
+
+    // 牛顿迭代解开普勒方程
+    double E = M + e * std::sin(M);
+    for (int i = 0; i < 20; i++) {
+        double dE = (E - e * std::sin(E) - M) / (1.0 - e * std::cos(E));
+        E -= dE;
+        if (std::fabs(dE) < 1e-15) {
+            break;
+        }
+    }
+
+    // 轨道平面内的坐标，再依次转过近日点幅角、倾角和升交点黄经
+    const double xp = a * (std::cos(E) - e);
+    const double yp = a * std::sqrt(1.0 - e * e) * std::sin(E);
+    const double co = std::cos(omega), so = std::sin(omega);
+    const double cn = std::cos(node), sn = std::sin(node);
+    const double ci = std::cos(I), si = std::sin(I);
+    position[0] = (co * cn - so * sn * ci) * xp + (-so * cn - co * sn * ci) * yp;
+    position[1] = (co * sn + so * cn * ci) * xp + (-so * sn + co * cn * ci) * yp;
+    position[2] = (so * si) * xp + (co * si) * yp;
+}
+
+// 在[start, start + length]上用n个切比雪夫节点拟合，系数写入out[component * n + k]
+void fitInterval(const PlanetElements& p, double start, double length, uint32_t n, double* out)
+{
+    std::vector<double> samples(3 * n);
+    for (uint32_t j = 0; j < n; j++) {
+        double x = std::cos(PI * (j + 0.5) / n);
+        planetPosition(p, start + 0.5 * (x + 1.0) * length, &samples[3 * j]);
+    }
+    for (int component = 0; component < 3; component++) {
+        for (uint32_t k = 0; k < n; k++) {
+            double sum = 0.0;
+            for (uint32_t j = 0; j < n; j++) {
+                sum += samples[3 * j + component] * std::cos(PI * k * (j + 0.5) / n);
+            }
+            out[component * n + k] = (k == 0 ? 1.0 : 2.0) * sum / n;
+        }
+    }
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    if (argc < 2) {
+        std::printf("usage: make_ephemeris <output> [startYear] [endYear]\n");
+        return 1;
+    }
+    const double startYear = argc >= 3 ? std::atof(argv[2]) : 1600.0;
+    const double endYear = argc >= 4 ? std::atof(argv[3]) : 2600.0;
+    if (!(endYear > startYear)) {
+        std::printf("endYear must be after startYear\n");
+        return 1;
+    }
+
+    // 起点对齐到J2000前后的整段，J2000正好落在段的边界上
+    const double startDay = J2000 + std::floor((startYear - 2000.0) * DAYS_PER_YEAR / SEGMENT_DAYS) * SEGMENT_DAYS;
+    const uint64_t segmentCount = static_cast<uint64_t>(std::ceil((J2000 + (endYear - 2000.0) * DAYS_PER_YEAR - startDay) / SEGMENT_DAYS));
+
+    std::vector<EphemerisBody> bodies;
+    for (const PlanetElements& p : PLANETS) {
+        EphemerisBody body = {};
+        std::strncpy(body.name, p.name, EPHEMERIS_NAME_LENGTH - 1);
+        body.coefficients = p.coefficients;
+        body.subintervals = p.subintervals;
+        bodies.push_back(body);
+    }
+    const uint32_t segmentDoubles = LayoutEphemerisBodies(bodies);
+
+    std::vector<double> segments(segmentCount * segmentDoubles);
+    for (uint64_t s = 0; s < segmentCount; s++) {
+        for (size_t b = 0; b < bodies.size(); b++) {
+            const double subDays = SEGMENT_DAYS / bodies[b].subintervals;
+            for (uint32_t sub = 0; sub < bodies[b].subintervals; sub++) {
+                double* out = &segments[s * segmentDoubles + bodies[b].offset + 3 * bodies[b].coefficients * sub];
+                fitInterval(PLANETS[b], startDay + s * SEGMENT_DAYS + sub * subDays, subDays, bodies[b].coefficients, out);
+            }
+        }
+    }
+
+    if (!WriteEphemeris(argv[1], startDay, SEGMENT_DAYS, bodies, segments)) {
+        std::printf("failed to write %s\n", argv[1]);
+        return 1;
+    }
+
+    // 读回文件，在各子区间之间的随机时刻与解析位置比较，报告拟合误差
+    Ephemeris ephemeris;
+    if (!ephemeris.Open(argv[1])) {
+        std::printf("failed to read back %s\n", argv[1]);
+        return 1;
+    }
+    std::printf("%s: %zu bodies, %llu segments of %.0f days (JD %.1f - %.1f), %.1f MB\n", argv[1], bodies.size(),
+                static_cast<unsigned long long>(segmentCount), SEGMENT_DAYS, ephemeris.StartDay(), ephemeris.EndDay(),
+                (segments.size() * sizeof(double)) / 1e6);
+    for (size_t b = 0; b < bodies.size(); b++) {
+        double worst = 0.0;
+        for (int i = 0; i < 2000; i++) {
+            double day = ephemeris.StartDay() + (ephemeris.EndDay() - ephemeris.StartDay()) * (i + 0.37) / 2000.0;
+            double fitted[3], exact[3];
+            ephemeris.Position(b, day, fitted);
+            planetPosition(PLANETS[b], day, exact);
+            worst = std::fmax(worst, std::sqrt((fitted[0] - exact[0]) * (fitted[0] - exact[0]) + (fitted[1] - exact[1]) * (fitted[1] - exact[1])
+                                               + (fitted[2] - exact[2]) * (fitted[2] - exact[2])));
+        }
+        std::printf("  %-8s max fit error %.3g km\n", bodies[b].name, worst * KM_PER_AU);
+    }
+    return 0;
+}
@@ -0,0 +1,131 @@
+// 生成星表文件
+//   make_starcat <output> [count]           生成count颗合成恒星（默认100万），星等分布和银河面聚集近似真实星空
+//   make_starcat <output> --csv <input>     从CSV转换，每行为 赤经(度),赤纬(度),视星等,B-V色指数，无法解析的行（如表头）跳过
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../include/star_catalog.h"
+
+namespace {
+
+const double DEG = 3.14159265358979323846 / 180.0;
+
+// 黄赤交角
+const double OBLIQUITY = 23.4393 * DEG;
+
+// 肉眼可见（6.5等以内）的恒星约9000颗，更暗的恒星数每等约增加10^0.45倍
+const double NAKED_EYE_LIMIT = 6.5;
+const double NAKED_EYE_COUNT = 9000.0;
+const double COUNT_SLOPE = 0.45;
+const double BRIGHTEST_MAGNITUDE = -1.46;
+
+struct Vector {
+    double x, y, z;
+};
+
+Vector fromAngles(double longitude, double latitude)
+{
+    return { std::cos(latitude) * std::cos(longitude), std::cos(latitude) * std::sin(longitude), std::sin(latitude) };
+}
+
+Vector cross(const Vector& a, const Vector& b)
+{
+    return { a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x };
+}
+
+// 赤道坐标方向 -> 场景坐标：先绕x轴转到黄道坐标，再按 (x, z, -y) 映射，Y轴朝上（与KeplerBatch一致）
+StarRecord makeStar(const Vector& equatorial, double magnitude, double colorIndex)
+{
+    const double c = std::cos(OBLIQUITY), s = std::sin(OBLIQUITY);
+    const double x = equatorial.x;
+    const double y = equatorial.y * c + equatorial.z * s;
+    const double z = -equatorial.y * s + equatorial.z * c;
+    return { static_cast<float>(x), static_cast<float>(z), static_cast<float>(-y),
+             static_cast<float>(magnitude), static_cast<float>(colorIndex) };
+}
+
+// 合成星空：一半恒星集中在银河面附近，星等按累计计数 N(<m) ∝ 10^(0.45 m) 抽样
+std::vector<StarRecord> synthesize(size_t count)
+{
+    // 银道坐标基向量（赤道坐标）：北银极和银心方向
+    const Vector pole = fromAngles(192.8595 * DEG, 27.1283 * DEG);
+    const Vector center = fromAngles(266.4050 * DEG, -28.9362 * DEG);
+    const Vector side = cross(pole, center);
+
+    // 最暗的星等使星表恰好包含count颗恒星
+    const double faintest = NAKED_EYE_LIMIT + std::log10(count / NAKED_EYE_COUNT) / COUNT_SLOPE;
+
+    std::mt19937 random(20240601);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    std::normal_distribution<double> diskLatitude(0.0, 12.0 * DEG);
+    std::normal_distribution<double> colorIndex(0.65, 0.35);
+
+    std::vector<StarRecord> stars;
+    stars.reserve(count);
+    for (size_t i = 0; i < count; i++) {
+        double l = 2.0 * 3.14159265358979323846 * unit(random);
+        double b = unit(random) < 0.5 ? diskLatitude(random) : std::asin(2.0 * unit(random) - 1.0);
+        b = std::fmax(-0.5 * 3.14159265358979323846, std::fmin(0.5 * 3.14159265358979323846, b));
+        Vector g = fromAngles(l, b);
+        Vector equatorial = { g.x * center.x + g.y * side.x + g.z * pole.x,
+                              g.x * center.y + g.y * side.y + g.z * pole.y,
+                              g.x * center.z + g.y * side.z + g.z * pole.z };
+
+        double magnitude = std::fmax(BRIGHTEST_MAGNITUDE, faintest + std::log10(1.0 - unit(random)) / COUNT_SLOPE);
+        double bv = std::fmax(-0.4, std::fmin(2.0, colorIndex(random)));
+        stars.push_back(makeStar(equatorial, magnitude, bv));
+    }
+    return stars;
+}
+
+bool readCsv(const char* path, std::vector<StarRecord>& stars)
+{
+    std::ifstream file(path);
+    if (!file) {
+        return false;
+    }
+    std::string line;
+    while (std::getline(file, line)) {
+        double ra, dec, magnitude, bv;
+        if (std::sscanf(line.c_str(), "%lf,%lf,%lf,%lf", &ra, &dec, &magnitude, &bv) != 4) {
+            continue;
+        }
+        stars.push_back(makeStar(fromAngles(ra * DEG, dec * DEG), magnitude, bv));
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    if (argc < 2) {
+        std::printf("usage: make_starcat <output> [count]\n"
+                    "       make_starcat <output> --csv <input>\n");
+        return 1;
+    }
+
+    std::vector<StarRecord> stars;
+    if (argc >= 4 && std::strcmp(argv[2], "--csv") == 0) {
+        if (!readCsv(argv[3], stars)) {
+            std::printf("failed to read %s\n", argv[3]);
+            return 1;
+        }
+    } else {
+        size_t count = argc >= 3 ? std::strtoull(argv[2], nullptr, 10) : 1000000;
+        stars = synthesize(count);
+    }
+
+    if (!WriteStarCatalog(argv[1], stars)) {
+        std::printf("failed to write %s\n", argv[1]);
+        return 1;
+    }
+    std::printf("%s: %zu stars\n", argv[1], stars.size());
+    return 0;
+}